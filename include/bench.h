@@ -0,0 +1,28 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <Arduino.h>
+#include <ESP8266WebServer.h>
+
+// Off in release builds; the nodemcuv2_bench env builds with
+// -D BENCH_ENABLED=1 to serve /bench
+#ifndef BENCH_ENABLED
+#define BENCH_ENABLED 0
+#endif
+
+// --- Configuration ---
+#define BENCH_TIME_US 20000 // per benchmark; all of them stay under a stall
+
+// --- Benchmarks ---
+// On-device microbenchmarks of the pure-logic hot paths: base64,
+// Transmission response parsing (HTTP headers, chunked framing, filtered
+// JSON) and the status bar change detection. /bench reports ns/op from the
+// CPU cycle counter and, in builds with -D UMM_STATS_FULL=1, heap
+// allocations per op. Nothing here touches flash or the network; the
+// config store and RPC round trip are benchmarked on the host, in
+// test/test_bench (pio test -e native).
+#if BENCH_ENABLED
+void benchHandle(ESP8266WebServer &server);
+#endif
+
+#endif
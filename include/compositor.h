@@ -0,0 +1,58 @@
+#ifndef COMPOSITOR_H
+#define COMPOSITOR_H
+
+#include <Arduino.h>
+#include <TFT_eSPI.h>
+
+// --- Configuration ---
+#define COMP_AREA_Y 25 // main area: everything below the status bar
+#define COMP_AREA_W 240
+#define COMP_AREA_H 295
+#define COMP_MAX_WIDGETS 24
+#define COMP_MAX_DIRTY 8
+#define COMP_LABEL_LEN 40          // characters, a full line at size 1
+#define COMP_STRIP_H 16            // 240 x 16 RGB565 strip buffer = 7.5 KB
+#define COMP_FRAME_BUDGET (240 * 32) // pixels pushed per compositorFlush()
+
+// Screen rectangle a custom widget is asked to repaint
+struct WidgetClip {
+  int16_t x, y, w, h;
+};
+
+// Draws the part of a custom widget inside clip. Positions are screen
+// coordinates shifted by (ox, oy); gfx clips everything else.
+typedef void (*WidgetRender)(TFT_eSPI &gfx, int ox, int oy,
+                             const WidgetClip &clip);
+// Formats a number widget's value into exactly its width in characters
+typedef void (*WidgetFormat)(char *out, size_t size, long value);
+
+// --- Widget Compositor ---
+// Widgets in the main display area keep their bounds and content, and a
+// change only marks the pixels it affects dirty: the character cells whose
+// glyph changed, the span a bar moved by, a graph column. Overlapping dirty
+// rectangles are merged, and compositorFlush() renders them through a strip
+// buffer, one SPI window per strip, up to COMP_FRAME_BUDGET pixels per call.
+// A full-screen repaint is spread over several loop passes.
+void compositorBegin(uint16_t background); // new screen: drops all widgets
+void compositorFlush();
+bool compositorIdle(); // nothing left to push
+uint16_t compositorFrameWindows(); // SPI windows of the last flush
+uint32_t compositorFrameBytes();   // SPI bytes of the last flush
+
+// Constructors return a widget id, or -1 when the table is full
+int widgetLabel(int x, int y, uint8_t chars, uint8_t size, uint16_t fg,
+                uint16_t bg, const char *text);
+int widgetNumber(int x, int y, uint8_t chars, uint8_t size, uint16_t fg,
+                 uint16_t bg, WidgetFormat format);
+int widgetBar(int x, int y, int w, int h, uint16_t fg, uint16_t bg);
+int widgetIcon(int x, int y, int w, int h, const uint16_t *image);
+int widgetCustom(int x, int y, int w, int h, WidgetRender render);
+
+void widgetSetText(int id, const char *text);
+void widgetSetValue(int id, long value);                   // number
+void widgetSetLevel(int id, uint32_t value, uint32_t max); // bar
+void widgetSetImage(int id, const uint16_t *image);        // PROGMEM RGB565
+void widgetInvalidate(int id);
+void widgetInvalidateRect(int id, int x, int y, int w, int h); // relative
+
+#endif
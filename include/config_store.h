@@ -0,0 +1,23 @@
+#ifndef CONFIG_STORE_H
+#define CONFIG_STORE_H
+
+#include <Arduino.h>
+
+#include "settings.h"
+
+// --- Configuration ---
+#define CONFIG_STORE_FILE "/config.bin"
+#define CONFIG_STORE_TMP "/config.tmp"
+#define CONFIG_STORE_MAGIC 0x47464354 // "TCFG"
+#define CONFIG_SCHEMA_VERSION 2       // 2: Settings struct, 1: flat record
+
+// --- Config Store ---
+// The Settings struct behind a header (magic, schema version, size, CRC32).
+// Saves go to a temp file that is renamed over the old one, so a power loss
+// leaves either the old or the new record, never a torn one. Records from
+// older schema versions are converted on load.
+bool configStoreLoad(Settings &s);
+bool configStoreSave(const Settings &s); // no-op if unchanged
+void configStoreErase();
+
+#endif
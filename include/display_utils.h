@@ -7,14 +7,79 @@
 
 // --- Shared State ---
 enum State { STATE_AP_MODE, STATE_CONNECTING, STATE_CONNECTED };
+// What the main area shows while connected
+enum Screen { SCREEN_NONE, SCREEN_SPEED, SCREEN_TORRENTS };
 
 // --- External Globals ---
 extern TFT_eSPI tft;
 extern State currentState;
+extern Screen currentScreen;
+
+// --- SPI Traffic Accounting ---
+// Every window pushed to the panel costs its CASET/PASET/RAMWR framing
+// (3 command + 8 parameter bytes) on top of 2 bytes per RGB565 pixel.
+#define TFT_WINDOW_BYTES 11
+#ifdef SPI_FREQUENCY
+#define TFT_SPI_HZ SPI_FREQUENCY
+#else
+#define TFT_SPI_HZ 27000000
+#endif
+
+struct DisplayTraffic {
+  unsigned long windows;
+  unsigned long pixels;
+  unsigned long bytes;
+};
+
+// Everything pushed by the compositor and the status bar since boot
+extern DisplayTraffic displayTraffic;
+
+// Records one window of pixels; returns the bytes it put on the bus
+uint32_t displayCountWindow(uint32_t pixels);
+// Bus time for a byte count at TFT_SPI_HZ
+uint64_t displaySpiMicros(unsigned long bytes);
+// Pushes the w x h rectangle at (sx, sy) of a sprite to (x, y) as a single
+// window and records it; returns its bytes. TFT_eSprite::pushSprite() sends
+// one window per row unless the rectangle is the sprite's full width, so the
+// rows are packed to the start of the sprite's RAM first: what the sprite
+// held is lost.
+uint32_t displayPushRect(TFT_eSprite &sprite, int sx, int sy, int w, int h,
+                         int x, int y);
+
+// Status bar transfer size: last update, running total and update count
+extern uint32_t statusBarLastBytes;
+extern unsigned long statusBarBytesPushed;
+extern unsigned long statusBarUpdates;
+
+// --- Status Bar ---
+// What the bar shows, reduced to what changes its pixels. Kept free of
+// hardware access so the change detection can be run on its own (/bench).
+struct StatusBarView {
+  State state;
+  int8_t bars; // signal level 0-4, connected only
+  bool blink;  // connecting icon visible
+  IPAddress ip;
+};
+
+// Half-open screen rectangle of the status bar
+struct StatusWindow {
+  int16_t x0, y0, x1, y1;
+};
+
+StatusBarView statusBarView(State state, long rssi, bool blinkPhase,
+                            const IPAddress &ip);
+// Window that differs between two views; false when nothing does
+bool statusBarDiff(const StatusBarView &prev, const StatusBarView &next,
+                   StatusWindow &win);
 
 // --- Display Functions ---
-void drawStatusBar();
-void drawWifiIcon(int x, int y, long rssi);
-void drawAPIcon(int x, int y);
+void drawStatusBar(); // pushes only the part that changed
+void drawWifiIcon(TFT_eSPI &gfx, int x, int y, int bars); // bars: 0-4
+void drawAPIcon(TFT_eSPI &gfx, int x, int y);
+void speedViewBegin(); // adds the speed widgets to the connected screen
+void drawSpeedView(bool valid, uint32_t down, uint32_t up);
+void torrentViewBegin(); // adds the torrent list widgets
+void drawTorrentView();
+void drawNotice(const char *text); // one line at the bottom of the screen
 
 #endif
@@ -0,0 +1,20 @@
+#ifndef EVENT_STREAM_H
+#define EVENT_STREAM_H
+
+#include <Arduino.h>
+#include <ESP8266WebServer.h>
+
+// --- Configuration ---
+#define SSE_MAX_CLIENTS 3
+#define SSE_CHECK_INTERVAL 500   // ms between change checks (task period)
+#define SSE_KEEPALIVE_INTERVAL 15000
+
+// --- Server-Sent Events ---
+// /events keeps one long-lived connection per browser and pushes a "status"
+// event (RSSI and Transmission speeds) only when a value changes, and a
+// "torrents" event when the torrent list changed.
+void sseHandleSubscribe(ESP8266WebServer &server);
+void sseLoop(); // run every SSE_CHECK_INTERVAL
+int sseSubscriberCount();
+
+#endif
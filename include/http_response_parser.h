@@ -0,0 +1,107 @@
+#ifndef HTTP_RESPONSE_PARSER_H
+#define HTTP_RESPONSE_PARSER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// --- Limits ---
+#define HTTP_MAX_HEADER_NAME 32
+#define HTTP_MAX_HEADER_VALUE 24
+#define HTTP_MAX_SESSION_ID 64
+#define HTTP_MAX_CONTENT_LENGTH 0x1000000L // 16 MB, far beyond any RPC reply
+#define HTTP_MAX_CHUNK_SIZE 0x1000000UL
+
+// Incremental HTTP/1.1 response header parser.
+// Bytes are fed as they arrive, in any split, and parsed in place: the
+// status code, Content-Length, Transfer-Encoding: chunked, Connection and
+// X-Transmission-Session-Id are extracted into fixed buffers without any
+// per-line allocation. A status that is not three digits or a
+// Content-Length that is malformed or above HTTP_MAX_CONTENT_LENGTH fails
+// the response. Has no Arduino dependencies.
+class HttpResponseParser {
+public:
+  void reset();
+
+  // Consumes bytes up to and including the blank line ending the headers
+  // and returns how many were used; the rest belong to the body.
+  size_t feed(const char *data, size_t len);
+
+  bool done() const { return _phase == PHASE_DONE; }
+  bool failed() const { return _phase == PHASE_ERROR; }
+  int status() const { return _status; }
+  long contentLength() const { return _contentLength; }
+  bool chunked() const { return _chunked; }
+  bool keepAlive() const { return _keepAlive; }
+  const char *sessionId() const { return _sessionId; }
+
+private:
+  enum Phase {
+    PHASE_VERSION,
+    PHASE_STATUS,
+    PHASE_REASON,
+    PHASE_LINE_START,
+    PHASE_NAME,
+    PHASE_VALUE_START,
+    PHASE_VALUE,
+    PHASE_END_LF,
+    PHASE_DONE,
+    PHASE_ERROR
+  };
+  enum Header {
+    HEADER_OTHER,
+    HEADER_CONTENT_LENGTH,
+    HEADER_TRANSFER_ENCODING,
+    HEADER_CONNECTION,
+    HEADER_SESSION_ID
+  };
+
+  void step(char c);
+  void beginValue();
+  void endValue();
+
+  Phase _phase = PHASE_VERSION;
+  Header _header = HEADER_OTHER;
+  int _status = 0;
+  long _contentLength = -1;
+  bool _chunked = false;
+  bool _keepAlive = true;
+  bool _http10 = false;
+
+  char _name[HTTP_MAX_HEADER_NAME];
+  uint8_t _nameLen = 0;
+  char _value[HTTP_MAX_HEADER_VALUE];
+  uint8_t _valueLen = 0;
+  char _sessionId[HTTP_MAX_SESSION_ID] = "";
+  uint8_t _sessionIdLen = 0;
+  uint8_t _versionLen = 0;
+  uint8_t _statusDigits = 0;
+};
+
+// Decodes a Transfer-Encoding: chunked body one byte at a time.
+// feed() returns true when the byte is payload, false for chunk framing.
+// A chunk size above HTTP_MAX_CHUNK_SIZE fails the body.
+class HttpChunkDecoder {
+public:
+  void reset();
+  bool feed(char c);
+  bool done() const { return _phase == CHUNK_DONE; }
+  bool failed() const { return _phase == CHUNK_ERROR; }
+  bool inData() const { return _phase == CHUNK_DATA; }
+
+private:
+  enum Phase {
+    CHUNK_SIZE,
+    CHUNK_EXTENSION,
+    CHUNK_DATA,
+    CHUNK_DATA_END,
+    CHUNK_TRAILER,
+    CHUNK_TRAILER_LINE,
+    CHUNK_DONE,
+    CHUNK_ERROR
+  };
+
+  Phase _phase = CHUNK_SIZE;
+  unsigned long _remaining = 0;
+};
+
+#endif
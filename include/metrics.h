@@ -0,0 +1,34 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <Arduino.h>
+#include <ESP8266WebServer.h>
+
+// Build with -D METRICS_ENABLED=0 to compile /metrics and all collection out
+#ifndef METRICS_ENABLED
+#define METRICS_ENABLED 1
+#endif
+
+// --- Configuration ---
+#define METRICS_MAX_ROUTES 24
+#define METRICS_BUCKETS 10 // including +Inf
+
+// --- Prometheus Metrics ---
+// Fixed arrays only: observing a value is a bucket increment, and /metrics
+// is streamed from a stack buffer in the text exposition format.
+#if METRICS_ENABLED
+int metricsAddRoute(const char *uri, const char *method);
+void metricsObserveRoute(int route, uint32_t us);
+void metricsObserveRpc(uint32_t ms);
+void metricsLoopTick();
+void metricsSecondTick(); // once per second, from the scheduler
+void metricsHandle(ESP8266WebServer &server);
+#else
+inline int metricsAddRoute(const char *, const char *) { return -1; }
+inline void metricsObserveRoute(int, uint32_t) {}
+inline void metricsObserveRpc(uint32_t) {}
+inline void metricsLoopTick() {}
+inline void metricsSecondTick() {}
+#endif
+
+#endif
@@ -0,0 +1,42 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <Arduino.h>
+#include <ESP8266WebServer.h>
+
+// --- Configuration ---
+#define SCHED_MAX_TASKS 16
+
+typedef void (*TaskFn)();
+
+struct TaskInfo {
+  const char *name;
+  TaskFn fn;
+  uint32_t period;   // ms, 0 = every loop() pass
+  uint32_t budget;   // us a single run should stay under
+  unsigned long due; // millis() of the next run
+  uint16_t traceId;
+
+  // Statistics
+  uint32_t runs;
+  uint32_t maxUs;
+  uint64_t totalUs;
+  uint32_t overBudget; // runs that took longer than the budget
+  uint32_t missed;     // runs started a full period or more late
+};
+
+// --- Cooperative Scheduler ---
+// loop() only calls schedulerRun(); every subsystem is a registered task with
+// a period and a time budget, and the scheduler keeps per-task timing stats.
+// Tasks must not block: a slow run delays everything after it.
+int schedulerAdd(const char *name, TaskFn fn, uint32_t periodMs,
+                 uint32_t budgetUs);
+void schedulerRun();
+
+int schedulerTaskCount();
+const TaskInfo &schedulerTask(int i);
+uint32_t schedulerLoopMaxUs(); // slowest full pass
+
+void schedulerHandleStats(ESP8266WebServer &server); // /tasks JSON
+
+#endif
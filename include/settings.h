@@ -0,0 +1,69 @@
+#ifndef SETTINGS_H
+#define SETTINGS_H
+
+#include <Arduino.h>
+#include <ESP8266WebServer.h>
+
+// --- Capacities (including the terminating NUL) ---
+#define SETTINGS_MAX_NETWORKS 4
+#define SETTINGS_SSID_LEN 33
+#define SETTINGS_PASS_LEN 65
+#define SETTINGS_HOST_LEN 65
+#define SETTINGS_PATH_LEN 65
+#define SETTINGS_USER_LEN 33
+
+// --- Defaults ---
+#define SETTINGS_DEFAULT_PORT 9091
+#define SETTINGS_DEFAULT_PATH "/transmission/rpc"
+#define SETTINGS_DEFAULT_POLL 2 // seconds
+
+struct WifiNetwork {
+  char ssid[SETTINGS_SSID_LEN];
+  char pass[SETTINGS_PASS_LEN];
+};
+
+struct TransmissionSettings {
+  uint16_t port;
+  uint8_t poll; // seconds
+  uint8_t reserved;
+  char host[SETTINGS_HOST_LEN]; // empty = monitoring disabled
+  char path[SETTINGS_PATH_LEN];
+  char user[SETTINGS_USER_LEN];
+  char pass[SETTINGS_PASS_LEN];
+};
+
+// Persisted as-is by config_store (no padding, so the CRC is stable);
+// changing the layout needs a new schema version there.
+struct Settings {
+  TransmissionSettings trans;
+  uint8_t networkCount;
+  uint8_t reserved;
+  WifiNetwork networks[SETTINGS_MAX_NETWORKS]; // priority order
+};
+
+// --- Settings ---
+// All configuration lives in this one statically allocated struct with
+// fixed-capacity fields, so steady-state operation never touches the heap
+// for it. Setters validate and reject values that do not fit.
+extern Settings settings;
+
+void settingsDefaults(Settings &s);
+
+// Copies value into a fixed field, truncated to fit, and zeroes the rest of
+// the field: the whole struct is persisted and checksummed, so nothing of an
+// older, longer value may be left behind the NUL.
+void settingsCopyText(char *field, const char *value, size_t size);
+
+// Adds (or moves) a network to the top of the list; returns an error or null
+const char *settingsAddNetwork(const char *ssid, const char *pass);
+// The same without the length rules, for credentials saved before them;
+// only an empty SSID is refused, and over-long values are truncated
+bool settingsStoreNetwork(const char *ssid, const char *pass);
+bool settingsForgetNetwork(const char *ssid);
+
+// Overrides t with the host/port/path/user/pass/poll request args that are
+// present; returns an error or null. t is left unchanged on error.
+const char *settingsParseTransmission(TransmissionSettings &t,
+                                      ESP8266WebServer &server);
+
+#endif
@@ -0,0 +1,21 @@
+#ifndef SPEED_GRAPH_H
+#define SPEED_GRAPH_H
+
+#include <Arduino.h>
+
+#include "speed_monitor.h"
+
+// --- Graph Layout (main area, below the speed readout) ---
+#define GRAPH_X 10
+#define GRAPH_Y 182
+#define GRAPH_W SPEED_HISTORY
+#define GRAPH_H 120
+
+// --- Throughput Graph ---
+// Rolling download/upload history drawn as a sweep: every new sample
+// invalidates one column and the cursor, and the whole plot is only
+// repainted when the scale changes. Drawn by the compositor.
+void speedGraphAdd(uint32_t seq);
+void speedGraphBegin(); // adds the graph widgets to the connected screen
+
+#endif
@@ -0,0 +1,39 @@
+#ifndef SPEED_MONITOR_H
+#define SPEED_MONITOR_H
+
+#include <Arduino.h>
+
+#include "settings.h"
+#include "transmission_client.h"
+
+// --- Configuration ---
+#define SPEED_HISTORY 220 // one sample per graph column
+#define SPEED_BACKOFF_MAX 60000 // ms, longest wait after failed polls
+// The filtered session-stats reply: three slots, whose size depends on the
+// platform, and their keys, copied from the stream
+#define SPEED_STATS_DOC_SIZE (JSON_OBJECT_SIZE(3) + 48)
+
+struct SpeedSample {
+  uint32_t down; // bytes/s
+  uint32_t up;   // bytes/s
+};
+
+// --- Speed Monitor ---
+// Polls Transmission's session-stats in the background while connected and
+// keeps the latest speeds plus a ring buffer of recent samples. After a
+// failed poll the interval doubles with every further failure, up to
+// SPEED_BACKOFF_MAX, so an unreachable host (each connect() blocks for up
+// to RPC_CONNECT_TIMEOUT) does not stall loop() every poll. Its client
+// polls any request in flight; the torrent list shares it, and with it the
+// keep-alive socket and session id.
+void speedMonitorConfigure(const TransmissionSettings &target);
+void speedMonitorLoop();
+
+bool speedMonitorValid();
+const SpeedSample &speedLatest();
+int speedHistoryCount();
+uint32_t speedSampleCount(); // total samples ever taken
+const SpeedSample &speedHistory(int age); // 0 = newest
+TransmissionClient &speedMonitorClient();
+
+#endif
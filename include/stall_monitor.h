@@ -0,0 +1,56 @@
+#ifndef STALL_MONITOR_H
+#define STALL_MONITOR_H
+
+#include <Arduino.h>
+
+// --- Configuration ---
+#define STALL_THRESHOLD_MS 250
+#define STALL_RTC_OFFSET 8 // RTC blocks; follows the Wi-Fi fast connect cache
+#define STALL_NAME_LEN 16
+
+enum PostMortemKind : uint8_t {
+  PM_NONE,
+  PM_STALL, // a task or handler ran longer than STALL_THRESHOLD_MS
+  PM_CRASH  // exception or software watchdog, captured on the way down
+};
+
+struct PostMortem {
+  uint32_t crc; // over everything below
+  uint32_t durationMs;
+  uint32_t uptimeS;
+  uint32_t epc; // crash only
+  uint8_t kind;
+  uint8_t exccause; // crash only
+  uint8_t reserved[2];
+  char task[STALL_NAME_LEN];
+};
+
+// --- Stall Monitor ---
+// Tasks and handlers run inside a StallScope naming the current activity.
+// Any run over the threshold is counted and written to RTC memory, and a
+// crash or software watchdog reset records what was running when it hit.
+// The next boot reports the record together with its reset reason.
+void stallMonitorBegin(); // at boot: take over the previous record
+void stallCheckLoop(uint32_t us); // after each full loop() pass
+
+// Scopes nest (a route inside the "http" task); a stall is recorded once,
+// by the innermost scope that ran over.
+struct StallScope {
+  const char *prevName;
+  unsigned long prevSince;
+  uint32_t stallsAtStart;
+  explicit StallScope(const char *name);
+  ~StallScope();
+};
+
+uint32_t stallCount();
+uint32_t stallLastMs();
+
+// Previous boot
+bool postMortemValid();
+const PostMortem &postMortem();
+uint32_t postMortemResetReason();
+const char *postMortemReasonName();
+size_t postMortemSummary(char *buf, size_t size); // TFT line, 0 = nothing
+
+#endif
@@ -0,0 +1,23 @@
+#ifndef TEMPLATE_RENDERER_H
+#define TEMPLATE_RENDERER_H
+
+#include <Arduino.h>
+#include <ESP8266WebServer.h>
+
+// A page split at build time into static PROGMEM segments, each followed by
+// a slot id (TPL_NONE after the last one). Generated in web_assets.h.
+struct PageTemplate {
+  const char *const *segments;
+  const uint8_t *slots;
+  uint8_t count;
+};
+
+// Writes the value of a slot into buf and returns its length
+typedef size_t (*TemplateSlotFn)(uint8_t slot, char *buf, size_t size);
+
+// Streams the page with chunked transfer encoding, substituting (and HTML
+// escaping) slot values as it goes, so the page is never copied into RAM.
+void streamTemplate(ESP8266WebServer &server, const PageTemplate &tpl,
+                    TemplateSlotFn slotValue);
+
+#endif
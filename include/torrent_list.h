@@ -0,0 +1,55 @@
+#ifndef TORRENT_LIST_H
+#define TORRENT_LIST_H
+
+#include <Arduino.h>
+#include <ESP8266WebServer.h>
+
+#include "settings.h"
+
+// --- Configuration ---
+#define TORRENT_MAX 32       // table entries, most active kept
+#define TORRENT_NAME_LEN 32  // bytes kept of a name, including the NUL
+#define TORRENT_PAGE 16      // most ids asked for per torrent-get in a sync
+#define TORRENT_DOC_SIZE 4096 // one reply, allocated while a host is set
+#define TORRENT_POLL_INTERVAL 5000
+#define TORRENT_DELTA_WINDOW 50000 // recently-active covers the last 60 s
+#define TORRENT_RECOUNT_GAP 8 // empty pages in a row before a recount
+
+struct TorrentInfo {
+  uint32_t id;
+  uint32_t down;     // bytes/s
+  uint32_t up;       // bytes/s
+  int32_t eta;       // seconds, < 0 when unknown
+  uint32_t seen;     // poll that last reported it, for eviction
+  uint16_t permille; // percent done x 10
+  uint8_t status;    // Transmission's tr_torrent_activity
+  char name[TORRENT_NAME_LEN]; // empty until the name has been fetched
+};
+
+// --- Torrent List ---
+// Mirrors the Transmission torrent list into a fixed table keyed by id. A
+// sync pages through the ids with torrent-get, asking only for the fields
+// shown, until it has seen as many torrents as session-stats counts; ids
+// of deleted torrents leave gaps, so a run of empty pages counts again.
+// After that every poll asks for the "recently-active" torrents, so it
+// costs only as much as what changed, and merges them plus the "removed"
+// ids. A failed delta or one older than the server's 60 s activity window
+// starts a new sync. A reply too big for the document halves the page
+// instead. With more torrents than TORRENT_MAX the least active ones are
+// left out. Requests go through the speed monitor's client, in turn with
+// its own; configure after speedMonitorConfigure().
+void torrentListConfigure(const TransmissionSettings &target);
+void torrentListLoop();
+
+int torrentCount();                 // table entries, most active first
+const TorrentInfo &torrentAt(int i);
+uint32_t torrentTotal();            // torrents on the server
+bool torrentListSynced();
+uint32_t torrentListChanges();      // bumped whenever the table changes
+void torrentListHandle(ESP8266WebServer &server); // /torrents
+
+// Statistics
+uint16_t torrentLastRows();         // rows in the last reply
+unsigned long torrentSyncCount();   // full syncs run
+
+#endif
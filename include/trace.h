@@ -0,0 +1,61 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <Arduino.h>
+#include <ESP8266WebServer.h>
+
+// Build with -D TRACE_ENABLED=0 to compile /trace and all trace points out
+#ifndef TRACE_ENABLED
+#define TRACE_ENABLED 1
+#endif
+
+// --- Configuration ---
+#define TRACE_CAPACITY 512 // events, power of two (8 bytes each)
+#define TRACE_MAX_NAMES 48
+
+// Fixed trace names; tasks and routes register more at startup
+enum TraceName : uint16_t {
+  TRACE_LOOP,
+  TRACE_RPC,
+  TRACE_RPC_CONNECT,
+  TRACE_RPC_SENT,
+  TRACE_RPC_HEADERS,
+  TRACE_RPC_HANDSHAKE,
+  TRACE_RPC_PARSE,
+  TRACE_STATUS_BAR,
+  TRACE_DISPLAY_FLUSH,
+  TRACE_FIXED_NAMES
+};
+
+// --- Event Tracing ---
+// A ring buffer of 8-byte binary events (timestamp, name id, phase).
+// Recording a point is a few stores; names are only resolved when /trace
+// streams the buffer as Chrome trace_event JSON (chrome://tracing, Perfetto).
+#if TRACE_ENABLED
+uint16_t traceRegister(const char *name); // name must outlive the program
+void traceRecord(uint16_t id, char phase);
+void traceHandle(ESP8266WebServer &server);
+
+// Ends the span when the enclosing scope exits
+struct TraceScope {
+  uint16_t id;
+  explicit TraceScope(uint16_t id) : id(id) { traceRecord(id, 'B'); }
+  ~TraceScope() { traceRecord(id, 'E'); }
+};
+
+#define TRACE_BEGIN(id) traceRecord((id), 'B')
+#define TRACE_END(id) traceRecord((id), 'E')
+#define TRACE_INSTANT(id) traceRecord((id), 'i')
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+#define TRACE_SCOPE(id) TraceScope TRACE_CONCAT(traceScope_, __LINE__)(id)
+#else
+inline uint16_t traceRegister(const char *) { return 0; }
+
+#define TRACE_BEGIN(id) ((void)0)
+#define TRACE_END(id) ((void)0)
+#define TRACE_INSTANT(id) ((void)0)
+#define TRACE_SCOPE(id) ((void)0)
+#endif
+
+#endif
@@ -0,0 +1,124 @@
+#ifndef TRANSMISSION_CLIENT_H
+#define TRANSMISSION_CLIENT_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <ESP8266WiFi.h>
+
+#include "http_response_parser.h"
+#include "settings.h"
+
+// --- Timeouts (ms) ---
+#define RPC_CONNECT_TIMEOUT 2000
+#define RPC_RESPONSE_TIMEOUT 3000
+#define RPC_BODY_SETTLE_MS 20 // quiet time that ends a chunked body
+#define RPC_PARSE_WAIT_MS 50  // most the parser waits on the network, per body
+
+// --- Buffer Sizes ---
+#define RPC_AUTH_HEADER_LEN 192
+#define RPC_REQUEST_BUFFER 640
+#define RPC_RX_WINDOW 2144 // lwIP's TCP_WND (4 x 536 MSS), the most buffered
+
+// --- Request State ---
+enum RpcState {
+  RPC_IDLE,
+  RPC_CONNECTING,
+  RPC_SENDING,
+  RPC_READING_HEADERS,
+  RPC_READING_BODY,
+  RPC_DONE,
+  RPC_FAILED
+};
+
+// Asynchronous Transmission RPC client.
+// start() queues a request, poll() advances it a little on every loop() pass
+// (connect -> 409 handshake -> retry with session id -> read body), so the
+// web server, OTA and display keep running while a request is in flight.
+// The HTTP/1.1 connection is kept alive and the X-Transmission-Session-Id is
+// cached between requests; a new handshake only happens on another 409.
+// The reply is deserialized straight from the socket into the caller's
+// document, optionally through an ArduinoJson filter, so the body is never
+// copied out of the socket's buffers. Parsing waits until the body is
+// buffered, so it does not block loop() on the network. Requests are
+// formatted into a preallocated buffer and the Basic-auth header is only
+// recomputed when the credentials change.
+// Callers sharing one client (and so its socket and session id) only
+// start() while it is idle() and release() a finished request once they
+// have read its result.
+class TransmissionClient {
+public:
+  void configure(const TransmissionSettings &target);
+  bool start(const char *payload, JsonDocument &result,
+             const JsonDocument *filter = nullptr);
+  void poll();
+  void reset();
+
+  bool busy() const { return _state != RPC_IDLE && !finished(); }
+  bool finished() const { return _state == RPC_DONE || _state == RPC_FAILED; }
+  bool idle() const { return _state == RPC_IDLE; }
+  void release() {
+    if (finished())
+      _state = RPC_IDLE;
+  }
+  RpcState state() const { return _state; }
+  const String &error() const { return _error; }
+
+  // The last reply did not fit the result document
+  bool tooLarge() const { return _tooLarge; }
+
+  // Largest heap drop seen while the last request was in flight
+  uint32_t peakHeapUsed() const { return _heapStart - _heapMin; }
+
+  // Duration of the last successful request, including any 409 handshake
+  unsigned long roundTripMs() const { return _roundTrip; }
+
+  // Connection statistics
+  unsigned long requests() const { return _requests; }
+  unsigned long reconnects() const { return _reconnects; }
+  unsigned long handshakes() const { return _handshakes; }
+
+private:
+  void sendRequest();
+  void processHeaders();
+  bool bodyBuffered();
+  void parseBody();
+  void finishResponse();
+  void fail(const char *message);
+
+  WiFiClient _client;
+  TransmissionSettings _target = {};
+
+  RpcState _state = RPC_IDLE;
+  const char *_payload = nullptr;
+  char _authHeader[RPC_AUTH_HEADER_LEN] = "";
+  char _request[RPC_REQUEST_BUFFER];
+  char _sessionId[HTTP_MAX_SESSION_ID] = "";
+  String _error;
+  HttpResponseParser _response;
+  HttpChunkDecoder _chunks;
+  JsonDocument *_result = nullptr;
+  const JsonDocument *_filter = nullptr;
+  bool _parsed = false;
+  bool _tooLarge = false;
+  int _attempt = 0;
+  long _headerRead = 0;
+  long _bodyRead = 0;
+  long _bodyBuffered = 0;
+  unsigned long _bodyGrewAt = 0;
+  bool _reused = false;
+  unsigned long _stateStart = 0;
+  uint32_t _heapStart = 0;
+  uint32_t _heapMin = 0;
+  unsigned long _startedAt = 0;
+  unsigned long _roundTrip = 0;
+
+  unsigned long _requests = 0;
+  unsigned long _reconnects = 0;
+  unsigned long _handshakes = 0;
+};
+
+// Encodes len bytes of input as Base64 into out (NUL terminated).
+// Returns the encoded length, or 0 if out is too small.
+size_t base64Encode(const char *input, size_t len, char *out, size_t outSize);
+
+#endif
@@ -0,0 +1,38 @@
+#ifndef WIFI_MANAGER_H
+#define WIFI_MANAGER_H
+
+#include <Arduino.h>
+
+#include "settings.h"
+
+// --- Configuration ---
+#define WIFI_FAST_CONNECT_TIMEOUT 4000 // ms before falling back to a full connect
+#define WIFI_ATTEMPT_TIMEOUT 10000     // ms per network before failing over
+#define WIFI_AP_FALLBACK_TIMEOUT 20000 // boot only: give up and start the AP
+#define WIFI_BACKOFF_MIN 1000
+#define WIFI_BACKOFF_MAX 60000
+#define WIFI_ROAM_INTERVAL 60000 // ms between background roaming scans
+#define WIFI_ROAM_HYSTERESIS 10  // dB a saved AP must beat the current one by
+#define WIFI_RTC_OFFSET 0 // RTC user memory block (4 bytes each)
+
+// --- Wi-Fi Manager ---
+// Station connect over settings.networks, ranked by last-seen RSSI from the
+// scan cache. A failed network fails over to the next one; a failed round
+// waits with exponential backoff. The last good BSSID, channel and IP
+// configuration are kept in RTC memory (survives resets, not power loss), so
+// a reboot can skip the channel scan and the DHCP exchange.
+void wifiBegin();
+bool wifiConnectLoop(); // call while connecting; true = give up, start AP
+void wifiOnConnected(); // call on the transition to STATE_CONNECTED
+void wifiOnDisconnected(); // call on the transition out of STATE_CONNECTED
+void wifiRoamLoop(); // call while connected
+
+// --- Metrics ---
+bool wifiFastConnectUsed();
+unsigned long wifiConnectTime(); // ms from boot to the first connection
+unsigned long wifiLastReconnectTime(); // ms from link loss to reconnect
+uint32_t wifiReconnectCount();
+uint32_t wifiFailoverCount();
+uint32_t wifiRoamCount();
+
+#endif
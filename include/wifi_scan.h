@@ -0,0 +1,31 @@
+#ifndef WIFI_SCAN_H
+#define WIFI_SCAN_H
+
+#include <Arduino.h>
+#include <ESP8266WebServer.h>
+
+// --- Configuration ---
+#define SCAN_MAX_RESULTS 24
+#define SCAN_TTL 30000 // ms before cached results are refreshed
+
+struct ScanResult {
+  char ssid[33]; // 32 bytes max + NUL
+  int8_t rssi;
+  uint8_t bssid[6]; // strongest AP for this SSID
+  uint8_t channel;
+};
+
+// --- Wi-Fi Scan Service ---
+// One asynchronous radio scan at a time. Results are cached with a
+// timestamp; requests get the cache at once while a stale one is refreshed
+// in the background, and concurrent requests share the same scan.
+void wifiScanRequest();
+void wifiScanLoop();
+void wifiScanHandle(ESP8266WebServer &server);
+
+bool wifiScanRunning();
+unsigned long wifiScanTime(); // millis() of the last completed scan, 0 = none
+int wifiScanCount();
+const ScanResult &wifiScanResult(int i);
+
+#endif
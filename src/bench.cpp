@@ -0,0 +1,161 @@
+#include "bench.h"
+
+#if BENCH_ENABLED
+
+#include <ArduinoJson.h>
+
+#include "display_utils.h"
+#include "http_response_parser.h"
+#include "speed_monitor.h"
+#include "transmission_client.h"
+
+#ifdef UMM_STATS_FULL
+#include <umm_malloc/umm_malloc.h>
+#endif
+
+typedef void (*BenchFn)(uint32_t i);
+
+struct Bench {
+  const char *name;
+  BenchFn fn;
+};
+
+// Keeps results alive so the compiler can't drop the work
+static volatile uint32_t sink;
+
+// --- Fixtures ---
+
+static const char credentials[] = "transmission:correct horse battery";
+
+static const char handshakeResponse[] =
+    "HTTP/1.1 409 Conflict\r\n"
+    "Server: Transmission\r\n"
+    "X-Transmission-Session-Id: "
+    "fB7Yq2ZfS1kC0xQeP4Jm8vW3tR6uN9hL5aD2gE1iO0yTzXcV\r\n"
+    "Date: Sat, 17 Oct 2026 12:00:00 GMT\r\n"
+    "Content-Length: 612\r\n"
+    "Content-Type: text/html; charset=ISO-8859-1\r\n"
+    "\r\n";
+
+static const char chunkedBody[] =
+    "48\r\n"
+    "{\"arguments\":{\"activeTorrentCount\":3,\"downloadSpeed\":1843200,"
+    "\"pausedTorr\r\n"
+    "46\r\n"
+    "entCount\":1,\"torrentCount\":4,\"uploadSpeed\":524288},\"result\":"
+    "\"success\"}\r\n"
+    "0\r\n\r\n";
+
+static const char statsBody[] =
+    "{\"arguments\":{\"activeTorrentCount\":3,\"cumulative-stats\":"
+    "{\"downloadedBytes\":912837123,\"filesAdded\":120,\"secondsActive\":"
+    "8812733,\"sessionCount\":42,\"uploadedBytes\":2038172312},"
+    "\"downloadSpeed\":1843200,\"pausedTorrentCount\":1,\"torrentCount\":4,"
+    "\"uploadSpeed\":524288},\"result\":\"success\"}";
+
+// --- Cases ---
+
+static void benchBase64(uint32_t) {
+  char out[64];
+  sink = base64Encode(credentials, sizeof(credentials) - 1, out, sizeof(out));
+}
+
+static void benchHttpHeaders(uint32_t) {
+  HttpResponseParser parser;
+  parser.reset();
+  sink = parser.feed(handshakeResponse, sizeof(handshakeResponse) - 1) +
+         parser.status();
+}
+
+static void benchChunked(uint32_t) {
+  HttpChunkDecoder chunks;
+  chunks.reset();
+  uint32_t data = 0;
+  for (const char *p = chunkedBody; *p; p++)
+    data += chunks.feed(*p);
+  sink = data;
+}
+
+static void benchStatsJson(uint32_t) {
+  // Same filter as the speed monitor's session-stats poll
+  static StaticJsonDocument<96> statsFilter;
+  const JsonDocument &filter = statsFilter;
+  if (statsFilter.isNull()) {
+    statsFilter["arguments"]["downloadSpeed"] = true;
+    statsFilter["arguments"]["uploadSpeed"] = true;
+  }
+  StaticJsonDocument<SPEED_STATS_DOC_SIZE> doc;
+  deserializeJson(doc, statsBody, sizeof(statsBody) - 1,
+                  DeserializationOption::Filter(filter));
+  sink = doc["arguments"]["downloadSpeed"] | 0UL;
+}
+
+static void benchStatusBarDiff(uint32_t i) {
+  static const IPAddress ip(192, 168, 1, 50);
+  StatusBarView prev =
+      statusBarView(STATE_CONNECTED, -55 - (long)(i % 40), false, ip);
+  StatusBarView next =
+      statusBarView(STATE_CONNECTED, -55 - (long)((i + 1) % 40), false, ip);
+  StatusWindow win;
+  sink = statusBarDiff(prev, next, win);
+}
+
+static const Bench benches[] = {
+    {"base64", benchBase64},
+    {"http_headers", benchHttpHeaders},
+    {"http_chunked", benchChunked},
+    {"rpc_stats_json", benchStatsJson},
+    {"status_bar_diff", benchStatusBarDiff},
+};
+
+// --- Runner ---
+
+static long allocCount() {
+#ifdef UMM_STATS_FULL
+  return umm_get_malloc_count() + umm_get_realloc_count();
+#else
+  return -1;
+#endif
+}
+
+void benchHandle(ESP8266WebServer &server) {
+  server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+  server.send(200, "application/json", "");
+  server.sendContent("{\"benchmarks\":[");
+
+  char buf[160];
+  for (size_t b = 0; b < sizeof(benches) / sizeof(benches[0]); b++) {
+    benches[b].fn(0); // warm up caches and lazy statics
+
+    uint32_t ops = 0;
+    long allocsBefore = allocCount();
+    uint32_t cyclesBefore = ESP.getCycleCount();
+    unsigned long start = micros();
+    do {
+      benches[b].fn(ops++);
+    } while (micros() - start < BENCH_TIME_US);
+    uint32_t cycles = ESP.getCycleCount() - cyclesBefore;
+    long allocs = allocCount() - allocsBefore;
+
+    float nsPerOp = cycles * 1000.0f / ESP.getCpuFreqMHz() / ops;
+    char allocText[16];
+    if (allocsBefore < 0)
+      strcpy(allocText, "null");
+    else
+      snprintf(allocText, sizeof(allocText), "%.2f", (float)allocs / ops);
+
+    int len = snprintf(buf, sizeof(buf),
+                       "%s{\"name\":\"%s\",\"ops\":%lu,\"ns_per_op\":%.0f,"
+                       "\"allocs_per_op\":%s}",
+                       b ? "," : "", benches[b].name, (unsigned long)ops,
+                       nsPerOp, allocText);
+    server.sendContent(buf, len);
+  }
+
+  int len = snprintf(buf, sizeof(buf), "],\"cpu_mhz\":%u}",
+                     (unsigned)ESP.getCpuFreqMHz());
+  server.sendContent(buf, len);
+  server.sendContent(""); // terminating chunk
+}
+
+#endif
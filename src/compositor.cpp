@@ -0,0 +1,363 @@
+#include "compositor.h"
+
+#include <limits.h>
+
+#include "display_utils.h"
+#include "trace.h"
+
+enum WidgetKind : uint8_t {
+  WIDGET_LABEL,
+  WIDGET_NUMBER,
+  WIDGET_BAR,
+  WIDGET_ICON,
+  WIDGET_CUSTOM
+};
+
+struct Widget {
+  int16_t x, y, w, h;
+  WidgetKind kind;
+  uint8_t size;  // text size
+  uint8_t chars; // text width in characters
+  uint16_t fg, bg;
+  long value;    // number: last value; bar: filled width in pixels
+  char text[COMP_LABEL_LEN + 1];
+  const uint16_t *image;
+  WidgetRender render;
+  WidgetFormat format;
+};
+
+// Half-open screen rectangle
+struct Rect {
+  int16_t x0, y0, x1, y1;
+};
+
+static Widget widgets[COMP_MAX_WIDGETS];
+static int widgetCount = 0;
+static Rect dirty[COMP_MAX_DIRTY];
+static int dirtyCount = 0;
+static uint16_t background = TFT_BLACK;
+
+static TFT_eSprite strip = TFT_eSprite(&tft);
+static int stripRows = 0; // 0 = not allocated yet
+
+// SPI traffic of the last compositorFlush() that pushed anything
+static uint16_t frameWindows = 0;
+static uint32_t frameBytes = 0;
+
+// --- Dirty Rectangles ---
+
+static long area(const Rect &r) {
+  return (long)(r.x1 - r.x0) * (r.y1 - r.y0);
+}
+
+static Rect unite(const Rect &a, const Rect &b) {
+  return {min(a.x0, b.x0), min(a.y0, b.y0), max(a.x1, b.x1),
+          max(a.y1, b.y1)};
+}
+
+static bool touches(const Rect &a, const Rect &b) {
+  return a.x0 <= b.x1 && b.x0 <= a.x1 && a.y0 <= b.y1 && b.y0 <= a.y1;
+}
+
+static void removeDirty(int i) {
+  dirty[i] = dirty[--dirtyCount];
+}
+
+static void addDirty(Rect r) {
+  r.x0 = max<int16_t>(r.x0, 0);
+  r.y0 = max<int16_t>(r.y0, COMP_AREA_Y);
+  r.x1 = min<int16_t>(r.x1, COMP_AREA_W);
+  r.y1 = min<int16_t>(r.y1, COMP_AREA_Y + COMP_AREA_H);
+  if (r.x0 >= r.x1 || r.y0 >= r.y1)
+    return;
+
+  // Swallow every rectangle this one overlaps or borders; the union may
+  // reach further ones, so rescan until nothing merges
+  for (int i = 0; i < dirtyCount;) {
+    if (touches(r, dirty[i])) {
+      r = unite(r, dirty[i]);
+      removeDirty(i);
+      i = 0;
+    } else {
+      i++;
+    }
+  }
+
+  // Table full: merge with the rectangle that grows the least
+  if (dirtyCount == COMP_MAX_DIRTY) {
+    int best = 0;
+    long bestGrowth = LONG_MAX;
+    for (int i = 0; i < dirtyCount; i++) {
+      long growth = area(unite(r, dirty[i])) - area(dirty[i]) - area(r);
+      if (growth < bestGrowth) {
+        bestGrowth = growth;
+        best = i;
+      }
+    }
+    r = unite(r, dirty[best]);
+    removeDirty(best);
+    addDirty(r);
+    return;
+  }
+  dirty[dirtyCount++] = r;
+}
+
+// --- Rendering ---
+
+static bool intersects(const Widget &w, const Rect &r) {
+  return w.x < r.x1 && r.x0 < w.x + w.w && w.y < r.y1 && r.y0 < w.y + w.h;
+}
+
+static void drawWidget(const Widget &w, int ox, int oy, const Rect &r) {
+  switch (w.kind) {
+  case WIDGET_LABEL:
+  case WIDGET_NUMBER: {
+    const int cell = 6 * w.size;
+    for (int i = 0; i < w.chars; i++) {
+      int x = w.x + i * cell;
+      if (x < r.x1 && r.x0 < x + cell)
+        strip.drawChar(x + ox, w.y + oy, w.text[i], w.fg, w.bg, w.size);
+    }
+    break;
+  }
+  case WIDGET_BAR:
+    strip.fillRect(w.x + ox, w.y + oy, w.value, w.h, w.fg);
+    strip.fillRect(w.x + w.value + ox, w.y + oy, w.w - w.value, w.h, w.bg);
+    break;
+  case WIDGET_ICON:
+    // A 16-bit sprite keeps the panel's byte order, high byte first
+    if (w.image) {
+      strip.setSwapBytes(true);
+      strip.pushImage(w.x + ox, w.y + oy, w.w, w.h, w.image);
+      strip.setSwapBytes(false);
+    }
+    break;
+  case WIDGET_CUSTOM: {
+    WidgetClip clip = {r.x0, r.y0, (int16_t)(r.x1 - r.x0),
+                       (int16_t)(r.y1 - r.y0)};
+    w.render(strip, ox, oy, clip);
+    break;
+  }
+  }
+}
+
+// Composes one strip of the screen and pushes it as a single window
+static void flushStrip(const Rect &r) {
+  strip.fillRect(0, 0, r.x1 - r.x0, r.y1 - r.y0, background);
+  for (int i = 0; i < widgetCount; i++) {
+    if (intersects(widgets[i], r))
+      drawWidget(widgets[i], -r.x0, -r.y0, r);
+  }
+  frameBytes += displayPushRect(strip, 0, 0, r.x1 - r.x0, r.y1 - r.y0, r.x0,
+                                r.y0);
+  frameWindows++;
+}
+
+static bool allocateStrip() {
+  if (stripRows)
+    return true;
+  strip.setColorDepth(16);
+  for (int rows = COMP_STRIP_H; rows >= 4; rows /= 2) {
+    if (strip.createSprite(COMP_AREA_W, rows)) {
+      stripRows = rows;
+      return true;
+    }
+  }
+  return false;
+}
+
+// --- Public API ---
+
+void compositorBegin(uint16_t bg) {
+  widgetCount = 0;
+  dirtyCount = 0;
+  background = bg;
+  addDirty({0, COMP_AREA_Y, COMP_AREA_W, COMP_AREA_Y + COMP_AREA_H});
+}
+
+void compositorFlush() {
+  if (!dirtyCount || !allocateStrip())
+    return;
+  TRACE_SCOPE(TRACE_DISPLAY_FLUSH);
+
+  frameWindows = 0;
+  frameBytes = 0;
+  long budget = COMP_FRAME_BUDGET;
+  while (dirtyCount) {
+    // Top-most rectangle first, so a full repaint sweeps down the screen
+    int next = 0;
+    for (int i = 1; i < dirtyCount; i++) {
+      if (dirty[i].y0 < dirty[next].y0)
+        next = i;
+    }
+    Rect &r = dirty[next];
+    Rect s = {r.x0, r.y0, r.x1, (int16_t)min<int>(r.y1, r.y0 + stripRows)};
+
+    // Always make progress, but never start a strip past the budget
+    if (area(s) > budget && budget < COMP_FRAME_BUDGET)
+      break;
+    flushStrip(s);
+    budget -= area(s);
+
+    r.y0 = s.y1;
+    if (r.y0 >= r.y1)
+      removeDirty(next);
+    if (budget <= 0)
+      break;
+  }
+}
+
+bool compositorIdle() { return dirtyCount == 0; }
+
+uint16_t compositorFrameWindows() { return frameWindows; }
+
+uint32_t compositorFrameBytes() { return frameBytes; }
+
+// --- Widgets ---
+
+static Widget *addWidget(WidgetKind kind, int x, int y, int w, int h) {
+  if (widgetCount >= COMP_MAX_WIDGETS) {
+    Serial.println("Widget table full");
+    return nullptr;
+  }
+  Widget &wd = widgets[widgetCount++];
+  memset(&wd, 0, sizeof(wd));
+  wd.kind = kind;
+  wd.x = x;
+  wd.y = y;
+  wd.w = w;
+  wd.h = h;
+  addDirty({(int16_t)x, (int16_t)y, (int16_t)(x + w), (int16_t)(y + h)});
+  return &wd;
+}
+
+static Widget *widget(int id, WidgetKind kind) {
+  if (id < 0 || id >= widgetCount || widgets[id].kind != kind)
+    return nullptr;
+  return &widgets[id];
+}
+
+static Widget *textWidget(int id) {
+  Widget *w = widget(id, WIDGET_LABEL);
+  return w ? w : widget(id, WIDGET_NUMBER);
+}
+
+static void invalidate(const Widget &w, int x, int y, int width, int height) {
+  addDirty({(int16_t)(w.x + x), (int16_t)(w.y + y),
+            (int16_t)(w.x + x + width), (int16_t)(w.y + y + height)});
+}
+
+int widgetLabel(int x, int y, uint8_t chars, uint8_t size, uint16_t fg,
+                uint16_t bg, const char *text) {
+  chars = min<uint8_t>(chars, COMP_LABEL_LEN);
+  Widget *w = addWidget(WIDGET_LABEL, x, y, chars * 6 * size, 8 * size);
+  if (!w)
+    return -1;
+  w->chars = chars;
+  w->size = size;
+  w->fg = fg;
+  w->bg = bg;
+  snprintf(w->text, sizeof(w->text), "%-*.*s", chars, chars, text);
+  return w - widgets;
+}
+
+int widgetNumber(int x, int y, uint8_t chars, uint8_t size, uint16_t fg,
+                 uint16_t bg, WidgetFormat format) {
+  int id = widgetLabel(x, y, chars, size, fg, bg, "");
+  if (id < 0)
+    return -1;
+  widgets[id].kind = WIDGET_NUMBER;
+  widgets[id].format = format;
+  widgets[id].value = LONG_MIN; // the first value always formats
+  return id;
+}
+
+int widgetBar(int x, int y, int w, int h, uint16_t fg, uint16_t bg) {
+  Widget *wd = addWidget(WIDGET_BAR, x, y, w, h);
+  if (!wd)
+    return -1;
+  wd->fg = fg;
+  wd->bg = bg;
+  return wd - widgets;
+}
+
+int widgetIcon(int x, int y, int w, int h, const uint16_t *image) {
+  Widget *wd = addWidget(WIDGET_ICON, x, y, w, h);
+  if (!wd)
+    return -1;
+  wd->image = image;
+  return wd - widgets;
+}
+
+int widgetCustom(int x, int y, int w, int h, WidgetRender render) {
+  Widget *wd = addWidget(WIDGET_CUSTOM, x, y, w, h);
+  if (!wd)
+    return -1;
+  wd->render = render;
+  return wd - widgets;
+}
+
+void widgetSetText(int id, const char *text) {
+  Widget *w = textWidget(id);
+  if (!w)
+    return;
+
+  char padded[COMP_LABEL_LEN + 1];
+  snprintf(padded, sizeof(padded), "%-*.*s", w->chars, w->chars, text);
+
+  // Only the run of character cells that actually changed
+  int first = -1, last = -1;
+  for (int i = 0; i < w->chars; i++) {
+    if (padded[i] != w->text[i]) {
+      if (first < 0)
+        first = i;
+      last = i;
+    }
+  }
+  if (first < 0)
+    return;
+  memcpy(w->text, padded, w->chars);
+  const int cell = 6 * w->size;
+  invalidate(*w, first * cell, 0, (last - first + 1) * cell, w->h);
+}
+
+void widgetSetValue(int id, long value) {
+  Widget *w = widget(id, WIDGET_NUMBER);
+  if (!w || w->value == value)
+    return;
+  w->value = value;
+  char text[COMP_LABEL_LEN + 1];
+  w->format(text, w->chars + 1, value);
+  widgetSetText(id, text);
+}
+
+void widgetSetLevel(int id, uint32_t value, uint32_t max) {
+  Widget *w = widget(id, WIDGET_BAR);
+  if (!w)
+    return;
+  long fill = max ? (long)min<uint64_t>((uint64_t)value * w->w / max, w->w)
+                  : 0;
+  if (fill == w->value)
+    return;
+  // Only the span between the old and the new end of the bar
+  invalidate(*w, min(fill, w->value), 0, abs(fill - w->value), w->h);
+  w->value = fill;
+}
+
+void widgetSetImage(int id, const uint16_t *image) {
+  Widget *w = widget(id, WIDGET_ICON);
+  if (!w || w->image == image)
+    return;
+  w->image = image;
+  invalidate(*w, 0, 0, w->w, w->h);
+}
+
+void widgetInvalidate(int id) {
+  if (id >= 0 && id < widgetCount)
+    invalidate(widgets[id], 0, 0, widgets[id].w, widgets[id].h);
+}
+
+void widgetInvalidateRect(int id, int x, int y, int w, int h) {
+  if (id >= 0 && id < widgetCount)
+    invalidate(widgets[id], x, y, w, h);
+}
@@ -0,0 +1,123 @@
+#include "config_store.h"
+
+#include <LittleFS.h>
+#include <coredecls.h>
+
+struct ConfigHeader {
+  uint32_t magic;
+  uint16_t version;
+  uint16_t size;
+  uint32_t crc;
+};
+
+// Schema version 1 (firmware 0.4.3)
+struct SettingsV1 {
+  uint8_t networkCount;
+  uint8_t transPoll;
+  uint16_t transPort;
+  WifiNetwork networks[SETTINGS_MAX_NETWORKS];
+  char transHost[SETTINGS_HOST_LEN];
+  char transPath[SETTINGS_PATH_LEN];
+  char transUser[SETTINGS_USER_LEN];
+  char transPass[SETTINGS_PASS_LEN];
+};
+
+static uint32_t storedCrc = 0; // CRC of the record on flash, 0 = unknown
+
+static uint32_t settingsCrc(const Settings &s) { return crc32(&s, sizeof(s)); }
+
+static void convertV1(const SettingsV1 &v1, Settings &s) {
+  settingsDefaults(s);
+  s.networkCount = min((int)v1.networkCount, SETTINGS_MAX_NETWORKS);
+  memcpy(s.networks, v1.networks, sizeof(s.networks));
+  memcpy(s.trans.host, v1.transHost, sizeof(s.trans.host));
+  memcpy(s.trans.path, v1.transPath, sizeof(s.trans.path));
+  memcpy(s.trans.user, v1.transUser, sizeof(s.trans.user));
+  memcpy(s.trans.pass, v1.transPass, sizeof(s.trans.pass));
+  s.trans.port = v1.transPort;
+  s.trans.poll = v1.transPoll;
+}
+
+// Reads the payload into buf and checks it against the header
+static bool readPayload(File &file, const ConfigHeader &hdr, void *buf,
+                        size_t size) {
+  return hdr.size == size &&
+         file.read((uint8_t *)buf, size) == size &&
+         hdr.crc == crc32(buf, size);
+}
+
+// Returns the schema version read, 0 if the file is missing or invalid
+static int readRecord(const char *path, Settings &s) {
+  File file = LittleFS.open(path, "r");
+  if (!file)
+    return 0;
+
+  ConfigHeader hdr;
+  bool ok = file.read((uint8_t *)&hdr, sizeof(hdr)) == sizeof(hdr) &&
+            hdr.magic == CONFIG_STORE_MAGIC;
+  if (ok && hdr.version == CONFIG_SCHEMA_VERSION) {
+    Settings tmp;
+    ok = readPayload(file, hdr, &tmp, sizeof(tmp));
+    if (ok)
+      s = tmp;
+  } else if (ok && hdr.version == 1) {
+    SettingsV1 v1;
+    ok = readPayload(file, hdr, &v1, sizeof(v1));
+    if (ok)
+      convertV1(v1, s);
+  } else {
+    ok = false;
+  }
+  file.close();
+  return ok ? hdr.version : 0;
+}
+
+bool configStoreLoad(Settings &s) {
+  int version = readRecord(CONFIG_STORE_FILE, s);
+  if (!version) {
+    // Power lost between writing the temp file and the rename
+    version = readRecord(CONFIG_STORE_TMP, s);
+    if (!version)
+      return false;
+    Serial.println("Config recovered from temp file");
+    LittleFS.rename(CONFIG_STORE_TMP, CONFIG_STORE_FILE);
+  }
+
+  storedCrc = settingsCrc(s);
+  if (version != CONFIG_SCHEMA_VERSION) {
+    storedCrc = 0;
+    configStoreSave(s); // upgrade the record on flash
+  }
+  return true;
+}
+
+bool configStoreSave(const Settings &s) {
+  uint32_t crc = settingsCrc(s);
+  if (crc == storedCrc && LittleFS.exists(CONFIG_STORE_FILE))
+    return true; // unchanged, spare the flash
+
+  ConfigHeader hdr = {CONFIG_STORE_MAGIC, CONFIG_SCHEMA_VERSION,
+                      (uint16_t)sizeof(s), crc};
+
+  File file = LittleFS.open(CONFIG_STORE_TMP, "w");
+  if (!file)
+    return false;
+  bool ok = file.write((const uint8_t *)&hdr, sizeof(hdr)) == sizeof(hdr) &&
+            file.write((const uint8_t *)&s, sizeof(s)) == sizeof(s);
+  file.close();
+
+  // LittleFS renames atomically, replacing the old record
+  if (!ok || !LittleFS.rename(CONFIG_STORE_TMP, CONFIG_STORE_FILE)) {
+    LittleFS.remove(CONFIG_STORE_TMP);
+    Serial.println("Config save failed");
+    return false;
+  }
+  storedCrc = crc;
+  return true;
+}
+
+void configStoreErase() {
+  LittleFS.remove(CONFIG_STORE_FILE);
+  LittleFS.remove(CONFIG_STORE_TMP);
+  storedCrc = 0;
+}
@@ -1,104 +1,350 @@
 #include "display_utils.h"
 
-// Tracking variables for differential updates
-static State lastState = (State)-1;
-static long lastRssi = -1000;
-static IPAddress lastIp;
-static bool lastBlinkState = false;
+#include "compositor.h"
+#include "icons.h"
+#include "torrent_list.h"
+#include "trace.h"
 
-void drawStatusBar() {
-  // 1. Determine current values
-  bool currentBlink = (millis() / 500) % 2 == 0;
-  long currentRssi = (currentState == STATE_CONNECTED) ? WiFi.RSSI() : 0;
-  IPAddress currentIp;
-  if (currentState == STATE_CONNECTED)
-    currentIp = WiFi.localIP();
-  else if (currentState == STATE_AP_MODE)
-    currentIp = WiFi.softAPIP();
+// --- Status Bar Layout ---
+#define STATUS_BAR_W 240
+#define STATUS_BAR_H 25 // including the border line at y = 24
+#define STATUS_ICON_X 205
+#define STATUS_ICON_Y 4
+#define STATUS_ICON_W ICON_W
+#define STATUS_ICON_H ICON_H
+#define STATUS_IP_X 5
+#define STATUS_IP_Y 4
+#define STATUS_IP_W 100
+#define STATUS_IP_H 20
+
+// The bar is composed in an 8-bit sprite (6 KB instead of 12 KB at 16 bits)
+// and only the changed part of it is pushed, in one windowed transfer
+// (see displayPushRect())
+static TFT_eSprite statusSprite = TFT_eSprite(&tft);
+static bool statusSpriteReady = false;
+
+// What the panel currently shows
+static StatusBarView lastView = {(State)-1, 0, false, IPAddress()};
+
+// --- Speed View Layout (main area, below the status bar) ---
+#define SPEED_VIEW_X 30
+#define SPEED_DOWN_Y 64
+#define SPEED_UP_Y 134
+#define SPEED_TEXT_SIZE 3
+#define SPEED_FIELD_LEN 10
+
+// --- Torrent View Layout (main area) ---
+#define TORRENT_VIEW_X 8
+#define TORRENT_HEADER_Y 32
+#define TORRENT_ROW_Y 48
+#define TORRENT_ROW_H 42 // name, info line and progress bar
+#define TORRENT_ROWS 6
+#define TORRENT_LINE_LEN 37
+#define TORRENT_BAR_W 222
+
+#define NOTICE_Y 306
+#define NOTICE_LEN 39
+
+DisplayTraffic displayTraffic = {0, 0, 0};
+
+// Speed view widgets on the connected screen
+static int downWidget = -1;
+static int upWidget = -1;
+
+// Torrent view widgets
+static int headerWidget = -1;
+static int nameWidgets[TORRENT_ROWS];
+static int infoWidgets[TORRENT_ROWS];
+static int barWidgets[TORRENT_ROWS];
+
+uint32_t statusBarLastBytes = 0;
+unsigned long statusBarBytesPushed = 0;
+unsigned long statusBarUpdates = 0;
+
+static int signalBars(long rssi) {
+  if (rssi >= -60)
+    return 4;
+  if (rssi >= -70)
+    return 3;
+  if (rssi >= -80)
+    return 2;
+  if (rssi >= -90)
+    return 1;
+  return 0;
+}
+
+// Draws the whole bar. Drawn straight to the panel, every primitive is a
+// window of its own; returns their bytes then, 0 for the sprite.
+static uint32_t composeStatusBar(TFT_eSPI &gfx, const StatusBarView &v) {
+  const bool panel = &gfx == &tft;
+  uint32_t bytes = 0;
+  gfx.fillRect(0, 0, STATUS_BAR_W, STATUS_BAR_H - 1, TFT_DARKGREY);
+  gfx.drawFastHLine(0, STATUS_BAR_H - 1, STATUS_BAR_W, TFT_WHITE);
+  if (panel)
+    bytes += displayCountWindow(STATUS_BAR_W * (STATUS_BAR_H - 1)) +
+             displayCountWindow(STATUS_BAR_W);
 
-  // 2. Check for changes
-  bool stateChanged = (currentState != lastState);
-  bool rssiChanged = (currentRssi != lastRssi);
-  bool ipChanged = (currentIp != lastIp);
-  bool blinkChanged = (currentBlink != lastBlinkState);
+  bool icon = true;
+  if (v.state == STATE_AP_MODE)
+    drawAPIcon(gfx, STATUS_ICON_X, STATUS_ICON_Y);
+  else if (v.state == STATE_CONNECTING && v.blink)
+    drawWifiIcon(gfx, STATUS_ICON_X, STATUS_ICON_Y, 4);
+  else if (v.state == STATE_CONNECTED)
+    drawWifiIcon(gfx, STATUS_ICON_X, STATUS_ICON_Y, v.bars);
+  else
+    icon = false;
+  if (panel && icon)
+    bytes += displayCountWindow(STATUS_ICON_W * STATUS_ICON_H);
+
+  if (v.ip[0] != 0) {
+    gfx.setTextSize(1);
+    gfx.setTextColor(TFT_WHITE, TFT_DARKGREY);
+    gfx.setCursor(STATUS_IP_X, STATUS_IP_Y);
+    int chars = gfx.printf("%d.%d", v.ip[0], v.ip[1]);
+    gfx.setCursor(STATUS_IP_X, STATUS_IP_Y + 10);
+    chars += gfx.printf("%d.%d", v.ip[2], v.ip[3]);
+    // Size 1 on a background: one 6 x 8 window per character
+    for (int i = 0; panel && i < chars; i++)
+      bytes += displayCountWindow(6 * 8);
+  }
+  return bytes;
+}
+
+StatusBarView statusBarView(State state, long rssi, bool blinkPhase,
+                            const IPAddress &ip) {
+  StatusBarView v;
+  v.state = state;
+  // RSSI only matters once it moves the bar count
+  v.bars = (state == STATE_CONNECTED) ? signalBars(rssi) : 0;
+  v.blink = (state == STATE_CONNECTING) && blinkPhase;
+  v.ip = (state == STATE_CONNECTING) ? IPAddress() : ip;
+  return v;
+}
 
-  // Icon Position (Right aligned)
-  int iconX = 205;
-  int iconY = 4;
+bool statusBarDiff(const StatusBarView &prev, const StatusBarView &next,
+                   StatusWindow &win) {
+  bool stateChanged = next.state != prev.state;
+  bool iconChanged =
+      stateChanged || next.bars != prev.bars || next.blink != prev.blink;
+  bool ipChanged = stateChanged || next.ip != prev.ip;
+  if (!iconChanged && !ipChanged)
+    return false;
 
-  // 3. Update Background and Border if state changed
+  // The whole bar on a state change, else the changed parts
   if (stateChanged) {
-    tft.fillRect(0, 0, 240, 24, TFT_DARKGREY);
-    tft.drawFastHLine(0, 24, 240, TFT_WHITE);
+    win = {0, 0, STATUS_BAR_W, STATUS_BAR_H};
+    return true;
   }
+  win.x0 = ipChanged ? STATUS_IP_X : STATUS_ICON_X;
+  win.y0 = ipChanged ? STATUS_IP_Y : STATUS_ICON_Y;
+  win.x1 = iconChanged ? STATUS_ICON_X + STATUS_ICON_W
+                       : STATUS_IP_X + STATUS_IP_W;
+  win.y1 = max(iconChanged ? STATUS_ICON_Y + STATUS_ICON_H : 0,
+               ipChanged ? STATUS_IP_Y + STATUS_IP_H : 0);
+  return true;
+}
 
-  // 4. Update Icon area
-  if (stateChanged || (currentState == STATE_CONNECTED && rssiChanged) ||
-      (currentState == STATE_CONNECTING && blinkChanged)) {
+void drawStatusBar() {
+  TRACE_SCOPE(TRACE_STATUS_BAR);
 
-    // Clear only icon area if not already cleared by stateChanged
-    if (!stateChanged) {
-      tft.fillRect(iconX, iconY, 30, 16, TFT_DARKGREY);
-    }
+  IPAddress ip;
+  if (currentState == STATE_CONNECTED)
+    ip = WiFi.localIP();
+  else if (currentState == STATE_AP_MODE)
+    ip = WiFi.softAPIP();
+  StatusBarView view =
+      statusBarView(currentState,
+                    currentState == STATE_CONNECTED ? WiFi.RSSI() : 0,
+                    (millis() / 500) % 2 == 0, ip);
 
-    if (currentState == STATE_AP_MODE) {
-      drawAPIcon(iconX, iconY);
-    } else if (currentState == STATE_CONNECTING) {
-      if (currentBlink)
-        drawWifiIcon(iconX, iconY, -50);
-    } else if (currentState == STATE_CONNECTED) {
-      drawWifiIcon(iconX, iconY, currentRssi);
-    } else {
-      tft.drawLine(iconX, iconY, iconX + 15, iconY + 15, TFT_RED);
-      tft.drawLine(iconX + 15, iconY, iconX, iconY + 15, TFT_RED);
-    }
+  StatusWindow win;
+  if (!statusBarDiff(lastView, view, win))
+    return;
+  lastView = view;
+
+  // Compose off-screen and push the changed window once. Without the
+  // sprite's RAM, draw straight to the panel as a full repaint.
+  if (!statusSpriteReady) {
+    statusSprite.setColorDepth(8);
+    statusSpriteReady =
+        statusSprite.createSprite(STATUS_BAR_W, STATUS_BAR_H) != nullptr;
   }
+  if (statusSpriteReady) {
+    // Composed whole every time, so packing the window may clobber it
+    composeStatusBar(statusSprite, view);
+    statusBarLastBytes =
+        displayPushRect(statusSprite, win.x0, win.y0, win.x1 - win.x0,
+                        win.y1 - win.y0, win.x0, win.y0);
+  } else {
+    statusBarLastBytes = composeStatusBar(tft, view);
+  }
+  statusBarBytesPushed += statusBarLastBytes;
+  statusBarUpdates++;
+}
 
-  // 5. Update IP Address area
-  if (stateChanged || ipChanged) {
-    tft.setTextSize(1);
-    tft.setTextColor(TFT_WHITE, TFT_DARKGREY);
+uint32_t displayCountWindow(uint32_t pixels) {
+  uint32_t bytes = TFT_WINDOW_BYTES + pixels * 2;
+  displayTraffic.windows++;
+  displayTraffic.pixels += pixels;
+  displayTraffic.bytes += bytes;
+  return bytes;
+}
 
-    if (currentIp[0] == 0) {
-      tft.fillRect(5, 4, 100, 20, TFT_DARKGREY);
-    } else {
-      tft.setCursor(5, 4);
-      tft.printf("%d.%d  ", currentIp[0], currentIp[1]);
+uint64_t displaySpiMicros(unsigned long bytes) {
+  return (uint64_t)bytes * 8 * 1000000 / TFT_SPI_HZ;
+}
 
-      tft.setCursor(5, 14);
-      tft.printf("%d.%d  ", currentIp[2], currentIp[3]);
-    }
+uint32_t displayPushRect(TFT_eSprite &sprite, int sx, int sy, int w, int h,
+                         int x, int y) {
+  uint8_t *ram = (uint8_t *)sprite.getPointer();
+  if (!ram || w <= 0 || h <= 0)
+    return 0;
+  const int depth = sprite.getColorDepth() / 8; // bytes per pixel
+  const int stride = sprite.width();
+  uint8_t *rect = ram + ((size_t)sy * stride + sx) * depth;
+  if (w != stride) {
+    // Each row moves down to the end of the previous one, never past its
+    // own start, so a forward pass does not overwrite unread rows
+    for (int row = 0; row < h; row++)
+      memmove(ram + (size_t)row * w * depth,
+              ram + ((size_t)(sy + row) * stride + sx) * depth, w * depth);
+    rect = ram;
   }
 
-  // 6. Store current state
-  lastState = currentState;
-  lastRssi = currentRssi;
-  lastIp = currentIp;
-  lastBlinkState = currentBlink;
+  // Sprite RAM already holds the panel's byte order
+  bool swap = tft.getSwapBytes();
+  tft.setSwapBytes(false);
+  if (depth == 2)
+    tft.pushImage(x, y, w, h, (uint16_t *)rect);
+  else
+    tft.pushImage(x, y, w, h, rect, true);
+  tft.setSwapBytes(swap);
+  return displayCountWindow((uint32_t)w * h);
 }
 
-void drawAPIcon(int x, int y) {
-  tft.fillRoundRect(x, y, 24, 16, 3, TFT_ORANGE);
-  tft.setTextColor(TFT_BLACK, TFT_ORANGE);
-  tft.setTextSize(1);
-  tft.setCursor(x + 6, y + 4);
-  tft.print("AP");
+// Icons are prerendered RGB565 (tools/build_icons.py): one pushImage each.
+// pushImage() is not virtual, so the target is picked explicitly.
+static void drawIcon(TFT_eSPI &gfx, int x, int y, const uint16_t *icon) {
+  if (&gfx == &statusSprite) {
+    statusSprite.pushImage(x, y, ICON_W, ICON_H, icon); // converts by value
+    return;
+  }
+  // The panel wants the high byte first
+  tft.setSwapBytes(true);
+  tft.pushImage(x, y, ICON_W, ICON_H, icon);
+  tft.setSwapBytes(false);
 }
 
-void drawWifiIcon(int x, int y, long rssi) {
-  int bars = 0;
-  if (rssi >= -60)
-    bars = 4;
-  else if (rssi >= -70)
-    bars = 3;
-  else if (rssi >= -80)
-    bars = 2;
-  else if (rssi >= -90)
-    bars = 1;
-
-  for (int i = 0; i < 4; i++) {
-    int h = (i + 1) * 4;
-    uint16_t color = (i < bars) ? TFT_GREEN : TFT_BLACK;
-    tft.fillRect(x + (i * 4), y + (16 - h), 3, h, color);
+void drawAPIcon(TFT_eSPI &gfx, int x, int y) { drawIcon(gfx, x, y, ap_icon); }
+
+void drawWifiIcon(TFT_eSPI &gfx, int x, int y, int bars) {
+  bars = constrain(bars, 0, WIFI_ICON_LEVELS - 1);
+  drawIcon(gfx, x, y, wifi_icons[bars]);
+}
+
+// Formats a speed right-aligned into exactly SPEED_FIELD_LEN characters;
+// a negative value means no valid reading
+static void formatSpeedField(char *out, size_t size, long speed) {
+  char text[16];
+  float kb = speed / 1024.0;
+  if (speed < 0)
+    snprintf(text, sizeof(text), "-- KB/s");
+  else if (kb > 1024)
+    snprintf(text, sizeof(text), "%.1f MB/s", kb / 1024.0);
+  else
+    snprintf(text, sizeof(text), "%.0f KB/s", kb);
+  snprintf(out, size, "%*s", SPEED_FIELD_LEN, text);
+}
+
+void speedViewBegin() {
+  widgetLabel(SPEED_VIEW_X, SPEED_DOWN_Y - 22, 8, 2, TFT_LIGHTGREY, TFT_BLACK,
+              "Download");
+  widgetLabel(SPEED_VIEW_X, SPEED_UP_Y - 22, 6, 2, TFT_LIGHTGREY, TFT_BLACK,
+              "Upload");
+  downWidget = widgetNumber(SPEED_VIEW_X, SPEED_DOWN_Y, SPEED_FIELD_LEN,
+                            SPEED_TEXT_SIZE, TFT_GREEN, TFT_BLACK,
+                            formatSpeedField);
+  upWidget = widgetNumber(SPEED_VIEW_X, SPEED_UP_Y, SPEED_FIELD_LEN,
+                          SPEED_TEXT_SIZE, TFT_CYAN, TFT_BLACK,
+                          formatSpeedField);
+}
+
+void drawSpeedView(bool valid, uint32_t down, uint32_t up) {
+  if (currentScreen != SCREEN_SPEED)
+    return;
+  // The widgets repaint only the character cells whose glyph changed
+  widgetSetValue(downWidget, valid ? (long)down : -1);
+  widgetSetValue(upWidget, valid ? (long)up : -1);
+}
+
+// Short speed for the torrent rows: "512K", "1.8M"
+static void formatRate(char *out, size_t size, uint32_t rate) {
+  if (rate >= 1024UL * 1024)
+    snprintf(out, size, "%.1fM", rate / 1048576.0);
+  else
+    snprintf(out, size, "%luK", (unsigned long)(rate / 1024));
+}
+
+static void formatEta(char *out, size_t size, int32_t eta) {
+  if (eta < 0)
+    snprintf(out, size, "--");
+  else if (eta >= 86400)
+    snprintf(out, size, "%ldd%02ldh", (long)(eta / 86400),
+             (long)(eta % 86400 / 3600));
+  else
+    snprintf(out, size, "%ldh%02ldm", (long)(eta / 3600),
+             (long)(eta % 3600 / 60));
+}
+
+void torrentViewBegin() {
+  headerWidget = widgetLabel(TORRENT_VIEW_X, TORRENT_HEADER_Y,
+                             TORRENT_LINE_LEN, 1, TFT_LIGHTGREY, TFT_BLACK,
+                             "");
+  for (int i = 0; i < TORRENT_ROWS; i++) {
+    int y = TORRENT_ROW_Y + i * TORRENT_ROW_H;
+    nameWidgets[i] = widgetLabel(TORRENT_VIEW_X, y, TORRENT_LINE_LEN, 1,
+                                 TFT_WHITE, TFT_BLACK, "");
+    infoWidgets[i] = widgetLabel(TORRENT_VIEW_X, y + 11, TORRENT_LINE_LEN, 1,
+                                 TFT_LIGHTGREY, TFT_BLACK, "");
+    barWidgets[i] = widgetBar(TORRENT_VIEW_X, y + 22, TORRENT_BAR_W, 4,
+                              TFT_GREEN, TFT_DARKGREY);
   }
 }
+
+void drawTorrentView() {
+  if (currentScreen != SCREEN_TORRENTS)
+    return;
+  char text[COMP_LABEL_LEN + 1];
+  snprintf(text, sizeof(text), "Torrents: %d of %lu%s", torrentCount(),
+           (unsigned long)torrentTotal(),
+           torrentListSynced() ? "" : " (syncing)");
+  widgetSetText(headerWidget, text);
+
+  // Rows follow the table's order, most active first; each label only
+  // repaints the character cells that changed
+  for (int i = 0; i < TORRENT_ROWS; i++) {
+    if (i >= torrentCount()) {
+      widgetSetText(nameWidgets[i], "");
+      widgetSetText(infoWidgets[i], "");
+      widgetSetLevel(barWidgets[i], 0, 1);
+      continue;
+    }
+    const TorrentInfo &t = torrentAt(i);
+    char down[8], up[8], eta[10];
+    formatRate(down, sizeof(down), t.down);
+    formatRate(up, sizeof(up), t.up);
+    formatEta(eta, sizeof(eta), t.eta);
+    widgetSetText(nameWidgets[i], t.name);
+    // Every field at its widest; the label keeps TORRENT_LINE_LEN of it
+    char info[sizeof("6553.5%  D ") + sizeof(down) + sizeof(" U ") +
+              sizeof(up) + sizeof(" ETA ") + sizeof(eta)];
+    snprintf(info, sizeof(info), "%3u.%u%%  D %-6s U %-6s ETA %s",
+             t.permille / 10U, t.permille % 10U, down, up, eta);
+    widgetSetText(infoWidgets[i], info);
+    widgetSetLevel(barWidgets[i], t.permille, 1000);
+  }
+}
+
+void drawNotice(const char *text) {
+  widgetLabel(4, NOTICE_Y + 2, NOTICE_LEN, 1, TFT_RED, TFT_BLACK, text);
+}
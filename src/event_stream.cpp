@@ -0,0 +1,117 @@
+#include "event_stream.h"
+
+#include "display_utils.h"
+#include "speed_monitor.h"
+#include "torrent_list.h"
+
+static WiFiClient subscribers[SSE_MAX_CLIENTS];
+
+static unsigned long lastSend = 0;
+static long lastRssi = 0;
+static uint32_t lastDown = 0;
+static uint32_t lastUp = 0;
+static bool lastValid = false;
+static uint32_t lastTorrents = 0;
+
+// Formats the current values as an SSE "status" event
+static int formatStatus(char *buf, size_t size, long rssi, bool valid,
+                        uint32_t down, uint32_t up) {
+  if (!valid)
+    return snprintf(buf, size, "event: status\ndata: {\"rssi\":%ld}\n\n",
+                    rssi);
+  return snprintf(buf, size,
+                  "event: status\ndata: {\"rssi\":%ld,\"down\":%lu,"
+                  "\"up\":%lu}\n\n",
+                  rssi, (unsigned long)down, (unsigned long)up);
+}
+
+static void sendToAll(const char *data, size_t len) {
+  for (int i = 0; i < SSE_MAX_CLIENTS; i++) {
+    WiFiClient &client = subscribers[i];
+    if (!client)
+      continue;
+    // A closed or stalled subscriber is dropped instead of blocking loop()
+    if (!client.connected() || client.write(data, len) != len) {
+      client.stop();
+      client = WiFiClient();
+    }
+  }
+  lastSend = millis();
+}
+
+void sseHandleSubscribe(ESP8266WebServer &server) {
+  int slot = -1;
+  for (int i = 0; i < SSE_MAX_CLIENTS; i++) {
+    if (!subscribers[i] || !subscribers[i].connected()) {
+      slot = i;
+      break;
+    }
+  }
+  if (slot < 0) {
+    server.send(503, "text/plain", "Too many subscribers");
+    return;
+  }
+
+  WiFiClient client = server.client();
+  client.setNoDelay(true);
+  client.setTimeout(200);
+
+  // Raw response: the connection outlives this handler
+  server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+  server.sendContent_P(PSTR("HTTP/1.1 200 OK\r\n"
+                            "Content-Type: text/event-stream\r\n"
+                            "Cache-Control: no-cache\r\n"
+                            "Connection: keep-alive\r\n\r\n"
+                            "retry: 3000\n\n"));
+
+  char buf[96];
+  long rssi = (currentState == STATE_CONNECTED) ? WiFi.RSSI() : 0;
+  int len = formatStatus(buf, sizeof(buf), rssi, speedMonitorValid(),
+                         speedLatest().down, speedLatest().up);
+  client.write(buf, len);
+
+  subscribers[slot] = client;
+}
+
+void sseLoop() {
+  if (sseSubscriberCount() == 0)
+    return;
+
+  // Only a note that the list changed; each page fetches /torrents itself
+  uint32_t changes = torrentListChanges();
+  if (changes != lastTorrents) {
+    char buf[48];
+    int len = snprintf(buf, sizeof(buf),
+                       "event: torrents\ndata: {\"total\":%lu}\n\n",
+                       (unsigned long)torrentTotal());
+    sendToAll(buf, len);
+    lastTorrents = changes;
+  }
+
+  long rssi = (currentState == STATE_CONNECTED) ? WiFi.RSSI() : 0;
+  bool valid = speedMonitorValid();
+  uint32_t down = speedLatest().down;
+  uint32_t up = speedLatest().up;
+
+  if (rssi != lastRssi || valid != lastValid ||
+      (valid && (down != lastDown || up != lastUp))) {
+    char buf[96];
+    int len = formatStatus(buf, sizeof(buf), rssi, valid, down, up);
+    sendToAll(buf, len);
+    lastRssi = rssi;
+    lastValid = valid;
+    lastDown = down;
+    lastUp = up;
+  } else if (millis() - lastSend > SSE_KEEPALIVE_INTERVAL) {
+    sendToAll(":\n\n", 3); // comment line keeps proxies and the socket alive
+  }
+}
+
+int sseSubscriberCount() {
+  int n = 0;
+  for (int i = 0; i < SSE_MAX_CLIENTS; i++) {
+    if (subscribers[i] && subscribers[i].connected())
+      n++;
+  }
+  return n;
+}
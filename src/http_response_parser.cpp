@@ -0,0 +1,236 @@
+#include "http_response_parser.h"
+
+#include <string.h>
+
+static char lower(char c) { return (c >= 'A' && c <= 'Z') ? c + 32 : c; }
+
+static bool nameIs(const char *name, uint8_t len, const char *expected) {
+  return len == strlen(expected) && memcmp(name, expected, len) == 0;
+}
+
+static int hexValue(char c) {
+  if (c >= '0' && c <= '9')
+    return c - '0';
+  c = lower(c);
+  if (c >= 'a' && c <= 'f')
+    return c - 'a' + 10;
+  return -1;
+}
+
+// --- HttpResponseParser ---
+
+void HttpResponseParser::reset() {
+  _phase = PHASE_VERSION;
+  _header = HEADER_OTHER;
+  _status = 0;
+  _contentLength = -1;
+  _chunked = false;
+  _keepAlive = true;
+  _http10 = false;
+  _nameLen = 0;
+  _valueLen = 0;
+  _sessionId[0] = '\0';
+  _sessionIdLen = 0;
+  _versionLen = 0;
+  _statusDigits = 0;
+}
+
+size_t HttpResponseParser::feed(const char *data, size_t len) {
+  for (size_t i = 0; i < len; i++) {
+    step(data[i]);
+    if (_phase == PHASE_DONE || _phase == PHASE_ERROR)
+      return i + 1;
+  }
+  return len;
+}
+
+void HttpResponseParser::step(char c) {
+  switch (_phase) {
+  case PHASE_VERSION:
+    // "HTTP/1.1 "
+    if (c == ' ') {
+      _keepAlive = !_http10;
+      _phase = PHASE_STATUS;
+    } else if (c == '\n' || ++_versionLen > 16) {
+      _phase = PHASE_ERROR;
+    } else if (_versionLen == 8 && c == '0') {
+      _http10 = true;
+    }
+    break;
+
+  case PHASE_STATUS:
+    // Exactly three digits
+    if (c >= '0' && c <= '9' && _statusDigits < 3) {
+      _status = _status * 10 + (c - '0');
+      _statusDigits++;
+    } else if (_statusDigits < 3) {
+      _phase = PHASE_ERROR;
+    } else if (c == ' ' || c == '\r') {
+      _phase = PHASE_REASON;
+    } else if (c == '\n') {
+      _phase = PHASE_LINE_START;
+    } else {
+      _phase = PHASE_ERROR;
+    }
+    break;
+
+  case PHASE_REASON:
+    if (c == '\n')
+      _phase = PHASE_LINE_START;
+    break;
+
+  case PHASE_LINE_START:
+    if (c == '\r') {
+      _phase = PHASE_END_LF;
+      break;
+    }
+    if (c == '\n') {
+      _phase = PHASE_DONE;
+      break;
+    }
+    _nameLen = 0;
+    _phase = PHASE_NAME;
+    // fall through
+  case PHASE_NAME:
+    if (c == ':') {
+      beginValue();
+      _phase = PHASE_VALUE_START;
+    } else if (c == '\n') {
+      _phase = PHASE_LINE_START; // malformed line, skip it
+    } else if (_nameLen < sizeof(_name)) {
+      // Longer names are truncated; none of them can match a known header
+      _name[_nameLen++] = lower(c);
+    }
+    break;
+
+  case PHASE_VALUE_START:
+    if (c == ' ' || c == '\t')
+      break;
+    _phase = PHASE_VALUE;
+    // fall through
+  case PHASE_VALUE:
+    if (c == '\r')
+      break;
+    if (c == '\n') {
+      _phase = PHASE_LINE_START;
+      endValue(); // may fail the response
+      break;
+    }
+    if (_header == HEADER_CONTENT_LENGTH) {
+      // Digits only, checked before they overflow. _valueLen counts the
+      // state: 0 before the first digit, 1 in the number, 2 after it.
+      if (c >= '0' && c <= '9' && _valueLen < 2 &&
+          _contentLength <= (HTTP_MAX_CONTENT_LENGTH - (c - '0')) / 10) {
+        _contentLength = _contentLength * 10 + (c - '0');
+        _valueLen = 1;
+      } else if ((c == ' ' || c == '\t') && _valueLen > 0) {
+        _valueLen = 2;
+      } else {
+        _phase = PHASE_ERROR;
+      }
+    } else if (_header == HEADER_SESSION_ID) {
+      if (c != ' ' && _sessionIdLen < sizeof(_sessionId) - 1)
+        _sessionId[_sessionIdLen++] = c;
+    } else if (_header != HEADER_OTHER) {
+      if (_valueLen < sizeof(_value) - 1)
+        _value[_valueLen++] = lower(c);
+    }
+    break;
+
+  case PHASE_END_LF:
+    _phase = (c == '\n') ? PHASE_DONE : PHASE_ERROR;
+    break;
+
+  default:
+    break;
+  }
+}
+
+void HttpResponseParser::beginValue() {
+  _valueLen = 0;
+  if (nameIs(_name, _nameLen, "content-length")) {
+    _header = HEADER_CONTENT_LENGTH;
+    _contentLength = 0;
+  } else if (nameIs(_name, _nameLen, "transfer-encoding")) {
+    _header = HEADER_TRANSFER_ENCODING;
+  } else if (nameIs(_name, _nameLen, "connection")) {
+    _header = HEADER_CONNECTION;
+  } else if (nameIs(_name, _nameLen, "x-transmission-session-id")) {
+    _header = HEADER_SESSION_ID;
+    _sessionIdLen = 0;
+  } else {
+    _header = HEADER_OTHER;
+  }
+}
+
+void HttpResponseParser::endValue() {
+  _value[_valueLen] = '\0';
+  if (_header == HEADER_CONTENT_LENGTH) {
+    if (_valueLen == 0) // no digits
+      _phase = PHASE_ERROR;
+  } else if (_header == HEADER_TRANSFER_ENCODING) {
+    _chunked = strstr(_value, "chunked") != nullptr;
+  } else if (_header == HEADER_CONNECTION) {
+    if (strstr(_value, "close"))
+      _keepAlive = false;
+    else if (strstr(_value, "keep-alive"))
+      _keepAlive = true;
+  } else if (_header == HEADER_SESSION_ID) {
+    _sessionId[_sessionIdLen] = '\0';
+  }
+  _header = HEADER_OTHER;
+}
+
+// --- HttpChunkDecoder ---
+
+void HttpChunkDecoder::reset() {
+  _phase = CHUNK_SIZE;
+  _remaining = 0;
+}
+
+bool HttpChunkDecoder::feed(char c) {
+  switch (_phase) {
+  case CHUNK_SIZE:
+  case CHUNK_EXTENSION:
+    if (c == '\n') {
+      _phase = _remaining ? CHUNK_DATA : CHUNK_TRAILER;
+    } else if (_phase == CHUNK_SIZE) {
+      int v = hexValue(c);
+      if (v >= 0 && _remaining <= (HTTP_MAX_CHUNK_SIZE - v) / 16)
+        _remaining = _remaining * 16 + v;
+      else if (v >= 0)
+        _phase = CHUNK_ERROR;
+      else if (c == ';')
+        _phase = CHUNK_EXTENSION;
+    }
+    return false;
+
+  case CHUNK_DATA:
+    if (--_remaining == 0)
+      _phase = CHUNK_DATA_END;
+    return true;
+
+  case CHUNK_DATA_END:
+    // CRLF after the chunk data
+    if (c == '\n') {
+      _remaining = 0;
+      _phase = CHUNK_SIZE;
+    }
+    return false;
+
+  case CHUNK_TRAILER:
+    if (c == '\n')
+      _phase = CHUNK_DONE;
+    else if (c != '\r')
+      _phase = CHUNK_TRAILER_LINE;
+    return false;
+
+  case CHUNK_TRAILER_LINE:
+    if (c == '\n')
+      _phase = CHUNK_TRAILER;
+    return false;
+
+  default:
+    return false;
+  }
+}
@@ -8,30 +8,42 @@
 #include <TFT_eSPI.h>
 #include <Updater.h>
 
+#include "bench.h"
+#include "compositor.h"
+#include "config_store.h"
 #include "display_utils.h"
-#include "web_pages.h"
+#include "event_stream.h"
+#include "metrics.h"
+#include "scheduler.h"
+#include "settings.h"
+#include "speed_graph.h"
+#include "speed_monitor.h"
+#include "stall_monitor.h"
+#include "torrent_list.h"
+#include "trace.h"
+#include "transmission_client.h"
+#include "web_assets.h"
+#include "wifi_manager.h"
+#include "wifi_scan.h"
 
 // --- Configuration ---
-const char *const VERSION = "0.2.9";
+const char *const VERSION = "0.5.5";
 
 const char *const BUILD_DATE = "2026. jan. 01.";
 const char *AP_SSID = "NodeMCU_Config";
-const char *CONFIG_FILE = "/config.json";
+const char *LEGACY_CONFIG_FILE = "/config.json"; // migrated to config_store
+const unsigned long SCREEN_CYCLE_INTERVAL = 10000;
 
 // --- Globals ---
 ESP8266WebServer server(80);
 TFT_eSPI tft = TFT_eSPI();
-String ssid = "";
-String password = "";
 
-// Transmission Settings
-String transHost = "";
-int transPort = 9091;
-String transPath = "/transmission/rpc";
-String transUser = "";
-String transPass = "";
+TransmissionClient testClient;
+StaticJsonDocument<128> testResult;
+StaticJsonDocument<96> statsFilter;
 
 State currentState = STATE_AP_MODE;
+Screen currentScreen = SCREEN_NONE;
 
 // LED Control
 #undef LED_BUILTIN
@@ -42,25 +54,42 @@ bool ledState = false;
 
 // --- Function Prototypes ---
 void loadConfig();
-void saveConfig();
+bool saveConfig();
+void migrateJsonConfig();
 
 void deleteConfig();
 void setupAP();
 void setupServerRoutes();
+void onRoute(const char *uri, HTTPMethod method,
+             ESP8266WebServer::THandlerFunction handler);
 void handleRoot();
-void handleScan();
+void handleInfo();
+void sendGzipPage(const uint8_t *data, size_t len, const char *etag);
+size_t dashboardSlot(uint8_t slot, char *buf, size_t size);
 void handleSave();
 void handleReset();
 void handleRestart();
 void handleStatus();
+void handleNetworks();
+void handleAddNetwork();
+void handleForgetNetwork();
 void updateLED();
+void showPostMortem();
+void showScreen(Screen screen);
+void cycleScreen();
+void requestRestart(unsigned long delayMs);
+void handlePendingRestart();
+void updateConnection();
+void setupTasks();
 void handleGetParams();
 void handleSaveParams();
 void handleTestTransmission();
+void handleTestResult();
 
 // --- Setup ---
 void setup() {
   Serial.begin(115200);
+  stallMonitorBegin();
 
   tft.init();
   tft.setRotation(2);
@@ -72,9 +101,9 @@ void setup() {
   pinMode(LED_BUILTIN, OUTPUT);
   digitalWrite(LED_BUILTIN, HIGH);
 
-  tft.fillRect(0, 0, 240, 24, TFT_DARKGREY);
-  tft.drawFastHLine(0, 24, 240, TFT_WHITE);
   drawStatusBar();
+  compositorBegin(TFT_BLACK);
+  showPostMortem();
 
   // --- OTA Setup ---
   ArduinoOTA.setHostname("NodeMCU-WiFi-LED");
@@ -116,60 +145,128 @@ void setup() {
   }
 
   loadConfig();
+  speedMonitorConfigure(settings.trans);
+  torrentListConfigure(settings.trans);
   setupServerRoutes();
 
-  if (ssid != "") {
+  if (settings.networkCount) {
     currentState = STATE_CONNECTING;
     WiFi.mode(WIFI_STA);
-    WiFi.begin(ssid, password);
-    Serial.print("Connecting to: ");
-    Serial.println(ssid);
+    wifiBegin();
   } else {
     setupAP();
   }
 
   server.begin();
   Serial.println("HTTP server started");
+
+  setupTasks();
+}
+
+// Period (ms, 0 = every pass) and time budget (us) per subsystem
+void setupTasks() {
+  schedulerAdd("ota", []() { ArduinoOTA.handle(); }, 0, 2000);
+  schedulerAdd("led", updateLED, 50, 100);
+  schedulerAdd("wifi", updateConnection, 100, 5000);
+  schedulerAdd("http", []() { server.handleClient(); }, 0, 20000);
+  schedulerAdd("rpc_test", []() { testClient.poll(); }, 0, 5000);
+  schedulerAdd("speed", speedMonitorLoop, 0, 5000);
+  schedulerAdd("torrents", torrentListLoop, 0, 5000);
+  schedulerAdd("sse", sseLoop, SSE_CHECK_INTERVAL, 5000);
+  schedulerAdd("scan", wifiScanLoop, 100, 5000);
+  schedulerAdd("status_bar", drawStatusBar, 500, 15000);
+  schedulerAdd("display", compositorFlush, 0, 10000);
+  schedulerAdd("screen", cycleScreen, SCREEN_CYCLE_INTERVAL, 2000);
+  schedulerAdd("restart", handlePendingRestart, 100, 100);
+#if METRICS_ENABLED
+  schedulerAdd("metrics", metricsSecondTick, 1000, 100);
+#endif
 }
 
 // --- Loop ---
 void loop() {
-  ArduinoOTA.handle();
-  updateLED();
+  TRACE_SCOPE(TRACE_LOOP);
+  schedulerRun();
+  metricsLoopTick();
+}
 
+// --- Implementation ---
+
+// Connect/disconnect transitions, failover and roaming
+void updateConnection() {
   if (currentState == STATE_CONNECTING) {
     if (WiFi.status() == WL_CONNECTED) {
       currentState = STATE_CONNECTED;
       Serial.println("\nConnected!");
       Serial.print("IP: ");
       Serial.println(WiFi.localIP());
+      wifiOnConnected();
 
-      tft.fillRect(0, 25, 240, 295, TFT_BLACK); // Clear only below status bar
       drawStatusBar();
+      showScreen(SCREEN_SPEED);
 
-    } else {
-      static unsigned long startAttemptInfo = millis();
-      if (millis() - startAttemptInfo > 20000) {
-        Serial.println("Connection timeout. Switching to AP.");
-        setupAP();
-      }
+    } else if (wifiConnectLoop()) {
+      Serial.println("Connection timeout. Switching to AP.");
+      setupAP();
     }
   } else if (currentState == STATE_CONNECTED) {
     if (WiFi.status() != WL_CONNECTED) {
       currentState = STATE_CONNECTING;
+      currentScreen = SCREEN_NONE; // the last readings stay up, frozen
+      wifiOnDisconnected();
+    } else {
+      wifiRoamLoop();
     }
   }
+}
 
-  server.handleClient();
-
-  static unsigned long lastStatusUpdate = 0;
-  if (millis() - lastStatusUpdate > 500) {
-    lastStatusUpdate = millis();
-    drawStatusBar();
+// Builds one of the connected screens in the main area
+void showScreen(Screen screen) {
+  currentScreen = screen;
+  compositorBegin(TFT_BLACK); // new main-area screen
+  if (screen == SCREEN_SPEED) {
+    speedViewBegin();
+    drawSpeedView(speedMonitorValid(), speedLatest().down, speedLatest().up);
+    speedGraphBegin();
+  } else {
+    torrentViewBegin();
+    drawTorrentView();
   }
+  showPostMortem();
 }
 
-// --- Implementation ---
+// Speed and torrent list take turns once there are torrents to show
+void cycleScreen() {
+  if (currentState != STATE_CONNECTED)
+    return;
+  Screen next = (currentScreen == SCREEN_SPEED && torrentCount() > 0)
+                    ? SCREEN_TORRENTS
+                    : SCREEN_SPEED;
+  if (next != currentScreen)
+    showScreen(next);
+}
+
+// Last reset's post-mortem, if any, on the bottom line of the screen
+void showPostMortem() {
+  char text[40];
+  if (postMortemSummary(text, sizeof(text)))
+    drawNotice(text);
+}
+
+// Restarts from the scheduler once the response has gone out, instead of
+// blocking the handler with delay()
+static unsigned long restartAt = 0;
+static bool restartPending = false;
+
+void requestRestart(unsigned long delayMs) {
+  restartAt = millis() + delayMs;
+  restartPending = true;
+}
+
+void handlePendingRestart() {
+  if (restartPending && (long)(millis() - restartAt) >= 0)
+    ESP.restart();
+}
 
 void updateLED() {
   unsigned long currentMillis = millis();
@@ -193,6 +290,7 @@ void updateLED() {
 
 void setupAP() {
   currentState = STATE_AP_MODE;
+  currentScreen = SCREEN_NONE;
   WiFi.mode(WIFI_AP);
   WiFi.softAP(AP_SSID);
 
@@ -200,33 +298,66 @@ void setupAP() {
   Serial.print("AP IP: ");
   Serial.println(WiFi.softAPIP());
 
-  tft.fillRect(0, 25, 240, 295, TFT_BLUE); // Clear only below status bar
+  compositorBegin(TFT_BLUE); // new main-area screen
   drawStatusBar();
 }
 
+// Registers a route whose handler latency is recorded for /metrics and
+// whose runs show up as spans in /trace
+void onRoute(const char *uri, HTTPMethod method,
+             ESP8266WebServer::THandlerFunction handler) {
+#if METRICS_ENABLED || TRACE_ENABLED
+  int route = metricsAddRoute(uri, method == HTTP_GET    ? "GET"
+                                   : method == HTTP_POST ? "POST"
+                                                         : "ANY");
+  uint16_t traceId = traceRegister(uri);
+  server.on(uri, method, [uri, route, traceId, handler]() {
+    TRACE_SCOPE(traceId);
+    StallScope stall(uri);
+    uint32_t start = micros();
+    handler();
+    metricsObserveRoute(route, micros() - start);
+  });
+#else
+  server.on(uri, method, [uri, handler]() {
+    StallScope stall(uri);
+    handler();
+  });
+#endif
+}
+
 void setupServerRoutes() {
-  server.on("/", handleRoot);
-  server.on("/save", HTTP_POST, handleSave);
-  server.on("/reset", HTTP_POST, handleReset);
-  server.on("/restart", HTTP_POST, handleRestart);
-  server.on("/status", handleStatus);
-  server.on("/getParams", handleGetParams);
-  server.on("/saveParams", HTTP_POST, handleSaveParams);
-  server.on("/testTransmission", HTTP_POST, handleTestTransmission);
+  static const char *headerKeys[] = {"If-None-Match", "Accept-Encoding"};
+  server.collectHeaders(headerKeys, 2);
+
+  onRoute("/", HTTP_ANY, handleRoot);
+  onRoute("/info", HTTP_ANY, handleInfo);
+  onRoute("/save", HTTP_POST, handleSave);
+  onRoute("/reset", HTTP_POST, handleReset);
+  onRoute("/restart", HTTP_POST, handleRestart);
+  onRoute("/status", HTTP_ANY, handleStatus);
+  onRoute("/torrents", HTTP_GET, []() { torrentListHandle(server); });
+  onRoute("/tasks", HTTP_GET, []() { schedulerHandleStats(server); });
+#if METRICS_ENABLED
+  onRoute("/metrics", HTTP_GET, []() { metricsHandle(server); });
+#endif
+#if TRACE_ENABLED
+  onRoute("/trace", HTTP_GET, []() { traceHandle(server); });
+#endif
+#if BENCH_ENABLED
+  onRoute("/bench", HTTP_GET, []() { benchHandle(server); });
+#endif
+  onRoute("/networks", HTTP_GET, handleNetworks);
+  onRoute("/networks", HTTP_POST, handleAddNetwork);
+  onRoute("/forgetNetwork", HTTP_POST, handleForgetNetwork);
+  onRoute("/events", HTTP_GET, []() { sseHandleSubscribe(server); });
+  onRoute("/getParams", HTTP_ANY, handleGetParams);
+  onRoute("/saveParams", HTTP_POST, handleSaveParams);
+  onRoute("/testTransmission", HTTP_POST, handleTestTransmission);
+  onRoute("/testTransmission", HTTP_GET, handleTestResult);
 
   // Web Config Handler
-  server.on("/scan", HTTP_GET, []() {
-    String json = "[";
-    int n = WiFi.scanNetworks();
-    for (int i = 0; i < n; ++i) {
-      if (i)
-        json += ",";
-      json += "{\"ssid\":\"" + WiFi.SSID(i) +
-              "\",\"rssi\":" + String(WiFi.RSSI(i)) + "}";
-    }
-    json += "]";
-    server.send(200, "application/json", json);
-  });
+  onRoute("/scan", HTTP_GET, []() { wifiScanHandle(server); });
 
   // Web OTA Handler
   server.on(
@@ -235,8 +366,7 @@ void setupServerRoutes() {
         server.send(200, "text/plain",
                     (Update.hasError()) ? "Update Failed"
                                         : "Update Success! Rebooting...");
-        delay(100);
-        ESP.restart();
+        requestRestart(100);
       },
       []() {
         HTTPUpload &upload = server.upload();
@@ -266,66 +396,131 @@ void setupServerRoutes() {
 }
 
 void loadConfig() {
-  if (LittleFS.exists(CONFIG_FILE)) {
-    File file = LittleFS.open(CONFIG_FILE, "r");
-    DynamicJsonDocument doc(512);
-    deserializeJson(doc, file);
-    ssid = doc["ssid"].as<String>();
-    password = doc["password"].as<String>();
-    if (doc.containsKey("t_host")) {
-      transHost = doc["t_host"].as<String>();
-      transPort = doc["t_port"] | 9091;
-      transPath = doc["t_path"].as<String>();
-      transUser = doc["t_user"].as<String>();
-      transPass = doc["t_pass"].as<String>();
-    }
-    file.close();
+  if (configStoreLoad(settings)) {
     Serial.println("Config loaded.");
+    return;
   }
+  settingsDefaults(settings);
+  if (LittleFS.exists(LEGACY_CONFIG_FILE))
+    migrateJsonConfig();
 }
 
-void saveConfig() {
-  DynamicJsonDocument doc(512);
-  doc["ssid"] = ssid;
-  doc["password"] = password;
-  doc["t_host"] = transHost;
-  doc["t_port"] = transPort;
-  doc["t_path"] = transPath;
-  doc["t_user"] = transUser;
-  doc["t_pass"] = transPass;
-
-  File file = LittleFS.open(CONFIG_FILE, "w");
-  serializeJson(doc, file);
+// A legacy network that breaks the current rules (say, a password shorter
+// than 8 characters) is logged and kept, not dropped
+static void migrateNetwork(const char *ssid, const char *pass) {
+  const char *error = settingsAddNetwork(ssid, pass);
+  if (!error)
+    return;
+  Serial.printf("Legacy network \"%s\": %s\n", ssid, error);
+  if (!settingsStoreNetwork(ssid, pass))
+    Serial.println("Legacy network without an SSID dropped");
+}
+
+// One-time import of the JSON config used before the binary store
+void migrateJsonConfig() {
+  File file = LittleFS.open(LEGACY_CONFIG_FILE, "r");
+  DynamicJsonDocument doc(1024);
+  deserializeJson(doc, file);
   file.close();
+
+  // Added lowest priority first, since each add goes to the front
+  JsonArray nets = doc["networks"];
+  for (int i = (int)nets.size() - 1; i >= 0; i--) {
+    migrateNetwork(nets[i]["ssid"] | "", nets[i]["pass"] | "");
+  }
+  // Older configs hold a single network
+  if (doc.containsKey("ssid"))
+    migrateNetwork(doc["ssid"] | "", doc["password"] | "");
+  if (doc.containsKey("t_host")) {
+    TransmissionSettings &t = settings.trans;
+    settingsCopyText(t.host, doc["t_host"] | "", sizeof(t.host));
+    t.port = doc["t_port"] | SETTINGS_DEFAULT_PORT;
+    settingsCopyText(t.path, doc["t_path"] | SETTINGS_DEFAULT_PATH,
+                     sizeof(t.path));
+    settingsCopyText(t.user, doc["t_user"] | "", sizeof(t.user));
+    settingsCopyText(t.pass, doc["t_pass"] | "", sizeof(t.pass));
+    t.poll = doc["t_poll"] | SETTINGS_DEFAULT_POLL;
+  }
+
+  if (saveConfig()) {
+    LittleFS.remove(LEGACY_CONFIG_FILE);
+    Serial.println("Config migrated to binary store.");
+  }
 }
 
-void deleteConfig() { LittleFS.remove(CONFIG_FILE); }
+bool saveConfig() { return configStoreSave(settings); }
+
+void deleteConfig() {
+  configStoreErase();
+  LittleFS.remove(LEGACY_CONFIG_FILE);
+}
 
 void handleRoot() {
-  if (currentState == STATE_CONNECTED) {
-    String page = FPSTR(dashboard_html);
-    page.replace("%SSID%", WiFi.SSID());
-
-    page.replace("%IP%", WiFi.localIP().toString());
-    page.replace("%RSSI%", String(WiFi.RSSI()));
-    page.replace("%MAC%", WiFi.macAddress());
-    server.send(200, "text/html", page);
+  bool gzip = server.header("Accept-Encoding").indexOf("gzip") >= 0;
+  // The encoding picks the variant, so caches must key on it
+  server.sendHeader("Vary", "Accept-Encoding");
+
+  if (currentState == STATE_CONNECTED && !gzip) {
+    streamTemplate(server, dashboard_tpl, dashboardSlot);
+  } else if (currentState == STATE_CONNECTED) {
+    sendGzipPage(dashboard_html_gz, dashboard_html_gz_len, dashboard_html_etag);
   } else {
-    server.send(200, "text/html", index_html);
+    sendGzipPage(index_html_gz, index_html_gz_len, index_html_etag);
   }
 }
 
-void handleScan() {
-  int n = WiFi.scanNetworks();
-  DynamicJsonDocument doc(2048);
-  JsonArray arr = doc.to<JsonArray>();
+// Serves a pre-compressed page; repeat visits revalidate with the ETag
+void sendGzipPage(const uint8_t *data, size_t len, const char *etag) {
+  // A 304 carries the same validator and cache headers as the 200
+  server.sendHeader("ETag", etag);
+  server.sendHeader("Cache-Control", "no-cache");
+  if (server.header("If-None-Match") == etag) {
+    server.send(304);
+    return;
+  }
+  server.sendHeader("Content-Encoding", "gzip");
+  server.send_P(200, "text/html", (PGM_P)data, len);
+}
 
-  for (int i = 0; i < n; ++i) {
-    JsonObject obj = arr.createNestedObject();
-    obj["ssid"] = WiFi.SSID(i);
-    obj["rssi"] = WiFi.RSSI(i);
+// Values for the %NAME% placeholders of the uncompressed dashboard template
+size_t dashboardSlot(uint8_t slot, char *buf, size_t size) {
+  IPAddress ip = WiFi.localIP();
+  uint8_t mac[6];
+
+  switch (slot) {
+  case TPL_SSID:
+    return strlcpy(buf, WiFi.SSID().c_str(), size);
+  case TPL_IP:
+    return snprintf(buf, size, "%u.%u.%u.%u", ip[0], ip[1], ip[2], ip[3]);
+  case TPL_RSSI:
+    return snprintf(buf, size, "%d", (int)WiFi.RSSI());
+  case TPL_MAC:
+    WiFi.macAddress(mac);
+    return snprintf(buf, size, "%02X:%02X:%02X:%02X:%02X:%02X", mac[0],
+                    mac[1], mac[2], mac[3], mac[4], mac[5]);
+  case TPL_VERSION:
+    return strlcpy(buf, VERSION, size);
+  default:
+    return 0;
   }
+}
 
+void handleInfo() {
+  DynamicJsonDocument doc(384);
+  doc["ssid"] = WiFi.SSID();
+  doc["ip"] = WiFi.localIP().toString();
+  doc["rssi"] = WiFi.RSSI();
+  doc["mac"] = WiFi.macAddress();
+  doc["version"] = VERSION;
+  doc["heap_free"] = ESP.getFreeHeap();
+  doc["heap_frag"] = ESP.getHeapFragmentation();
+  JsonObject wifi = doc.createNestedObject("wifi");
+  wifi["connect_ms"] = wifiConnectTime();
+  wifi["fast_connect"] = wifiFastConnectUsed();
+  wifi["reconnects"] = wifiReconnectCount();
+  wifi["reconnect_ms"] = wifiLastReconnectTime();
+  wifi["failovers"] = wifiFailoverCount();
+  wifi["roams"] = wifiRoamCount();
   String json;
   serializeJson(doc, json);
   server.send(200, "application/json", json);
@@ -333,258 +528,160 @@ void handleScan() {
 
 void handleSave() {
   if (server.hasArg("ssid") && server.hasArg("password")) {
-    ssid = server.arg("ssid");
-    password = server.arg("password");
+    const char *error = settingsAddNetwork(server.arg("ssid").c_str(),
+                                           server.arg("password").c_str());
+    if (error) {
+      server.send(400, "text/plain", error);
+      return;
+    }
     saveConfig();
 
     server.send(200, "text/plain", "Saved");
-    delay(1000);
-    ESP.restart();
+    requestRestart(1000);
   } else {
     server.send(400, "text/plain", "Missing args");
   }
 }
 
+void handleNetworks() {
+  DynamicJsonDocument doc(512);
+  JsonArray arr = doc.to<JsonArray>();
+  for (int i = 0; i < settings.networkCount; i++) {
+    const char *ssid = settings.networks[i].ssid;
+    JsonObject obj = arr.createNestedObject();
+    obj["ssid"] = ssid;
+    obj["current"] = currentState == STATE_CONNECTED && WiFi.SSID() == ssid;
+  }
+  String json;
+  serializeJson(doc, json);
+  server.send(200, "application/json", json);
+}
+
+void handleAddNetwork() {
+  const char *error = settingsAddNetwork(server.arg("ssid").c_str(),
+                                         server.arg("password").c_str());
+  if (error) {
+    server.send(400, "text/plain", error);
+    return;
+  }
+  saveConfig();
+  server.send(200, "text/plain", "Saved");
+}
+
+void handleForgetNetwork() {
+  if (!settingsForgetNetwork(server.arg("ssid").c_str())) {
+    server.send(404, "text/plain", "Unknown network");
+    return;
+  }
+  saveConfig();
+  server.send(200, "text/plain", "Removed");
+}
+
 void handleReset() {
   deleteConfig();
   server.send(200, "text/plain", "Reset");
-  delay(1000);
-  ESP.restart();
+  requestRestart(1000);
 }
 
 void handleRestart() {
   server.send(200, "text/plain", "Restarting...");
-  delay(1000);
-  ESP.restart();
+  requestRestart(1000);
 }
 
 void handleStatus() {
-  DynamicJsonDocument doc(64);
+  DynamicJsonDocument doc(96);
   doc["rssi"] = WiFi.RSSI();
+  if (speedMonitorValid()) {
+    doc["down"] = speedLatest().down;
+    doc["up"] = speedLatest().up;
+  }
   String json;
   serializeJson(doc, json);
   server.send(200, "application/json", json);
 }
 
 void handleGetParams() {
+  const TransmissionSettings &t = settings.trans;
   DynamicJsonDocument doc(256);
-  doc["host"] = transHost;
-  doc["port"] = transPort;
-  doc["path"] = transPath;
-  doc["user"] = transUser;
-  doc["pass"] = transPass;
+  doc["host"] = t.host;
+  doc["port"] = t.port;
+  doc["path"] = t.path;
+  doc["user"] = t.user;
+  doc["pass"] = t.pass;
+  doc["poll"] = t.poll;
   String json;
   serializeJson(doc, json);
   server.send(200, "application/json", json);
 }
 
 void handleSaveParams() {
-  transHost = server.arg("host");
-  transPort = server.arg("port").toInt();
-  transPath = server.arg("path");
-  transUser = server.arg("user");
-  transPass = server.arg("pass");
+  const char *error = settingsParseTransmission(settings.trans, server);
+  if (error) {
+    server.send(400, "text/plain", error);
+    return;
+  }
   saveConfig();
+  speedMonitorConfigure(settings.trans);
+  torrentListConfigure(settings.trans);
   server.send(200, "text/plain", "Params saved!");
 }
 
-// --- Base64 Helper ---
-static const char PROGMEM b64_alphabet[] =
-    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
-String base64Encode(String input) {
-  String output = "";
-  int i = 0, j = 0, len = input.length();
-  unsigned char char_array_3[3], char_array_4[4];
-
-  while (len--) {
-    char_array_3[i++] = input[j++];
-    if (i == 3) {
-      char_array_4[0] = (char_array_3[0] & 0xfc) >> 2;
-      char_array_4[1] =
-          ((char_array_3[0] & 0x03) << 4) + ((char_array_3[1] & 0xf0) >> 4);
-      char_array_4[2] =
-          ((char_array_3[1] & 0x0f) << 2) + ((char_array_3[2] & 0xc0) >> 6);
-      char_array_4[3] = char_array_3[2] & 0x3f;
-      for (i = 0; i < 4; i++)
-        output += (char)pgm_read_byte(&b64_alphabet[char_array_4[i]]);
-      i = 0;
-    }
-  }
-  if (i) {
-    for (j = i; j < 3; j++)
-      char_array_3[j] = '\0';
-    char_array_4[0] = (char_array_3[0] & 0xfc) >> 2;
-    char_array_4[1] =
-        ((char_array_3[0] & 0x03) << 4) + ((char_array_3[1] & 0xf0) >> 4);
-    char_array_4[2] =
-        ((char_array_3[1] & 0x0f) << 2) + ((char_array_3[2] & 0xc0) >> 6);
-    char_array_4[3] = char_array_3[2] & 0x3f;
-    for (j = 0; j < i + 1; j++)
-      output += (char)pgm_read_byte(&b64_alphabet[char_array_4[j]]);
-    while (i++ < 3)
-      output += '=';
-  }
-  return output;
-}
-
 void handleTestTransmission() {
-  String host = transHost;
-  int port = transPort;
-  String path = transPath;
-  String user = transUser;
-  String pass = transPass;
-
-  if (server.hasArg("host"))
-    host = server.arg("host");
-  if (server.hasArg("port"))
-    port = server.arg("port").toInt();
-  if (server.hasArg("path"))
-    path = server.arg("path");
-  // Important: Auth fields might be empty or not provided if unchanged,
-  // but for TEST button we send all fields usually.
-  // If not sent, we fall back to global.
-  // Actually, web_pages.h doesn't send user/pass currently in formdata?
-  // Checking web_pages.h... IT DOES NOT.
-  // Wait, I need to check if I updated web_pages.h to send user/pass.
-  // I did NOT update web_pages.h to send user/pass in v0.2.1/0.2.2.
-  // So I must rely on globals OR update web_pages.h too.
-  // Proceeding with GLOBALS for now as the user didn't explicitly ask to send
-  // inputs for auth, BUT the previous task said "It now uses the current values
-  // in the input fields". I missed adding user/pass to the FormData in
-  // frontend. I will check if server has args, if not use global.
-  if (server.hasArg("user"))
-    user = server.arg("user");
-  if (server.hasArg("pass"))
-    pass = server.arg("pass");
-
-  if (host == "") {
-    server.send(400, "text/plain", "Host invalid");
+  // Unsaved form values override the stored settings for the test only
+  TransmissionSettings target = settings.trans;
+  const char *error = settingsParseTransmission(target, server);
+  if (error || !target.host[0]) {
+    server.send(400, "text/plain", error ? error : "Host invalid");
     return;
   }
 
-  WiFiClient client;
-  if (!client.connect(host, port)) {
-    server.send(200, "text/plain", "Conn Failed (TCP)");
+  if (testClient.busy()) {
+    server.send(503, "text/plain", "Test already running");
     return;
   }
 
-  // Helper lambda to send request
-  auto sendRequest = [&](String sessionId) {
-    String auth = "";
-    if (user != "" || pass != "") {
-      auth = "Authorization: Basic " + base64Encode(user + ":" + pass) + "\r\n";
-    }
-
-    // JSON RPC payload for session-stats
-    String payload = "{\"method\":\"session-stats\"}";
-
-    client.print(
-        "POST " + path + " HTTP/1.1\r\n" + "Host: " + host + "\r\n" + auth +
-        (sessionId != "" ? "X-Transmission-Session-Id: " + sessionId + "\r\n"
-                         : "") +
-        "Content-Type: application/json\r\n" +
-        "Content-Length: " + String(payload.length()) + "\r\n" +
-        "Connection: close\r\n\r\n" + payload);
-  };
-
-  // 1. First attempt (likely to fail with 409 or 401)
-  sendRequest("");
-
-  unsigned long timeout = millis();
-  while (client.available() == 0) {
-    if (millis() - timeout > 3000) {
-      client.stop();
-      server.send(200, "text/plain", "Timeout (1)");
-      return;
-    }
-  }
-
-  String line = client.readStringUntil('\n');
-  String sessionId = "";
-  bool unauthorized = false;
-
-  // Parse headers
-  while (line.length() > 1) { // while not empty line
-    if (line.indexOf("409") > 0) {
-      // Conflict - good, look for session id
-    }
-    if (line.indexOf("401") > 0) {
-      unauthorized = true;
-    }
-    if (line.startsWith("X-Transmission-Session-Id: ")) {
-      sessionId = line.substring(27);
-      sessionId.trim();
-    }
-    line = client.readStringUntil('\n');
-  }
-
-  // Clear buffer
-  while (client.available())
-    client.read();
-  client.stop(); // Transmission usually closes on 409 anyway
+  // Only keep the fields the result message needs
+  statsFilter.clear();
+  statsFilter["result"] = true;
+  statsFilter["arguments"]["downloadSpeed"] = true;
+  statsFilter["arguments"]["uploadSpeed"] = true;
+
+  // The request runs from loop(); the page polls handleTestResult()
+  testClient.configure(target);
+  testClient.start("{\"method\":\"session-stats\"}", testResult,
+                   &statsFilter);
+  server.send(202, "text/plain", "Testing...");
+}
 
-  if (unauthorized) {
-    server.send(200, "text/plain", "Auth Failed (401)");
+void handleTestResult() {
+  if (testClient.busy()) {
+    server.send(202, "text/plain", "Testing...");
     return;
   }
-
-  if (sessionId == "") {
-    // Maybe it worked first time? (Unlikely for Transmission)
-    // Or invalid path?
-    server.send(200, "text/plain", "No Session ID (Path?)");
+  if (testClient.state() == RPC_FAILED) {
+    server.send(200, "text/plain", testClient.error());
     return;
   }
-
-  // 2. Second attempt with Session ID
-  if (!client.connect(host, port)) {
-    server.send(200, "text/plain", "Conn Failed (Reconnect)");
+  if (testClient.state() != RPC_DONE) {
+    server.send(404, "text/plain", "No test running");
     return;
   }
 
-  sendRequest(sessionId);
+  if (testResult["result"] == "success") {
+    auto formatSpeed = [](long speed) -> String {
+      float kmb = speed / 1024.0;
+      return (kmb > 1024) ? String(kmb / 1024.0, 1) + " MB/s"
+                          : String(kmb, 0) + " KB/s";
+    };
 
-  timeout = millis();
-  while (client.available() == 0) {
-    if (millis() - timeout > 3000) {
-      client.stop();
-      server.send(200, "text/plain", "Timeout (2)");
-      return;
-    }
-  }
+    long downSpeed = testResult["arguments"]["downloadSpeed"];
+    long upSpeed = testResult["arguments"]["uploadSpeed"];
 
-  // Read response
-  String response = client.readString();
-  client.stop();
-
-  // Simple parsing
-  int jsonStart = response.indexOf("{");
-  if (jsonStart > -1) {
-    String jsonBody = response.substring(jsonStart);
-    DynamicJsonDocument doc(1024);
-    DeserializationError error = deserializeJson(doc, jsonBody);
-    if (!error) {
-      if (doc["result"] == "success") {
-        auto formatSpeed = [](long speed) -> String {
-          float kmb = speed / 1024.0;
-          return (kmb > 1024) ? String(kmb / 1024.0, 1) + " MB/s"
-                              : String(kmb, 0) + " KB/s";
-        };
-
-        long downSpeed = doc["arguments"]["downloadSpeed"];
-        long upSpeed = doc["arguments"]["uploadSpeed"];
-
-        server.send(200, "text/plain",
-                    "Success! DL: " + formatSpeed(downSpeed) +
-                        " | UL: " + formatSpeed(upSpeed));
-      } else {
-
-        server.send(200, "text/plain",
-                    "RPC Error: " + doc["result"].as<String>());
-      }
-    } else {
-      server.send(200, "text/plain", "JSON Parse Err");
-    }
+    server.send(200, "text/plain",
+                "Success! DL: " + formatSpeed(downSpeed) +
+                    " | UL: " + formatSpeed(upSpeed));
   } else {
-    server.send(200, "text/plain", "Invalid Resp Body");
+    server.send(200, "text/plain",
+                "RPC Error: " + testResult["result"].as<String>());
   }
 }
@@ -0,0 +1,257 @@
+#include "metrics.h"
+
+#if METRICS_ENABLED
+
+#include <ESP8266WiFi.h>
+#include <stdarg.h>
+
+#include "compositor.h"
+#include "display_utils.h"
+#include "scheduler.h"
+#include "speed_monitor.h"
+#include "stall_monitor.h"
+#include "torrent_list.h"
+#include "wifi_manager.h"
+
+struct Histogram {
+  uint32_t counts[METRICS_BUCKETS]; // per bucket, not cumulative
+  uint64_t sum;
+};
+
+struct RouteMetrics {
+  const char *uri;
+  const char *method;
+  Histogram latency; // us
+};
+
+// Upper bounds; the last bucket is +Inf
+static const uint32_t routeBounds[METRICS_BUCKETS - 1] = {
+    1000, 5000, 10000, 25000, 50000, 100000, 250000, 500000, 1000000}; // us
+static const uint32_t rpcBounds[METRICS_BUCKETS - 1] = {
+    10, 25, 50, 100, 250, 500, 1000, 2500, 5000}; // ms
+
+static RouteMetrics routes[METRICS_MAX_ROUTES];
+static int routeCount = 0;
+static Histogram rpcLatency; // ms
+
+static uint32_t loopCount = 0;
+static uint32_t loopsLastSecond = 0;
+static uint32_t loopCountAtTick = 0;
+
+static void observe(Histogram &h, const uint32_t *bounds, uint32_t value) {
+  int i = 0;
+  while (i < METRICS_BUCKETS - 1 && value > bounds[i])
+    i++;
+  h.counts[i]++;
+  h.sum += value;
+}
+
+int metricsAddRoute(const char *uri, const char *method) {
+  if (routeCount >= METRICS_MAX_ROUTES)
+    return -1;
+  routes[routeCount].uri = uri;
+  routes[routeCount].method = method;
+  return routeCount++;
+}
+
+void metricsObserveRoute(int route, uint32_t us) {
+  if (route >= 0)
+    observe(routes[route].latency, routeBounds, us);
+}
+
+void metricsObserveRpc(uint32_t ms) { observe(rpcLatency, rpcBounds, ms); }
+
+void metricsLoopTick() { loopCount++; }
+
+void metricsSecondTick() {
+  loopsLastSecond = loopCount - loopCountAtTick;
+  loopCountAtTick = loopCount;
+}
+
+// --- Exposition ---
+
+// Lines are batched into one buffer so each chunk carries many of them
+static ESP8266WebServer *out;
+static char buf[512];
+static size_t bufLen = 0;
+
+static void flush() {
+  if (bufLen)
+    out->sendContent(buf, bufLen);
+  bufLen = 0;
+}
+
+static void emit(const char *fmt, ...) {
+  for (int attempt = 0; attempt < 2; attempt++) {
+    va_list args;
+    va_start(args, fmt);
+    int len = vsnprintf(buf + bufLen, sizeof(buf) - bufLen, fmt, args);
+    va_end(args);
+    if (len < 0)
+      return;
+    if (bufLen + len < sizeof(buf) || bufLen == 0) {
+      bufLen = min(bufLen + len, sizeof(buf) - 1);
+      return;
+    }
+    flush(); // did not fit behind the pending text; retry in an empty buffer
+  }
+}
+
+static void emitHeader(const char *name, const char *type, const char *help) {
+  emit("# HELP %s %s\n# TYPE %s %s\n", name, help, name, type);
+}
+
+static void emitGauge(const char *name, const char *help, long v) {
+  emitHeader(name, "gauge", help);
+  emit("%s %ld\n", name, v);
+}
+
+static void emitCounter(const char *name, const char *help, unsigned long v) {
+  emitHeader(name, "counter", help);
+  emit("%s %lu\n", name, v);
+}
+
+// scale: 1000000 for us -> seconds, 1000 for ms -> seconds
+static void emitSeconds(uint64_t value, uint32_t scale) {
+  unsigned long whole = value / scale;
+  unsigned long frac = (value % scale) * (1000000 / scale);
+  emit("%lu.%06lu", whole, frac);
+}
+
+static void emitHistogram(const char *name, const char *labels,
+                          const Histogram &h, const uint32_t *bounds,
+                          uint32_t scale) {
+  const char *sep = labels[0] ? "," : "";
+  uint32_t cumulative = 0;
+  for (int i = 0; i < METRICS_BUCKETS; i++) {
+    cumulative += h.counts[i];
+    emit("%s_bucket{%s%sle=\"", name, labels, sep);
+    if (i < METRICS_BUCKETS - 1)
+      emitSeconds(bounds[i], scale);
+    else
+      emit("+Inf");
+    emit("\"} %lu\n", (unsigned long)cumulative);
+  }
+  emit("%s_sum%s%s%s ", name, labels[0] ? "{" : "", labels,
+       labels[0] ? "}" : "");
+  emitSeconds(h.sum, scale);
+  emit("\n%s_count%s%s%s %lu\n", name, labels[0] ? "{" : "", labels,
+       labels[0] ? "}" : "", (unsigned long)cumulative);
+}
+
+void metricsHandle(ESP8266WebServer &server) {
+  out = &server;
+  server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+  server.send(200, "text/plain; version=0.0.4", "");
+
+  emitGauge("esp_uptime_seconds", "Time since boot.", millis() / 1000);
+  emitGauge("esp_heap_free_bytes", "Free heap.", ESP.getFreeHeap());
+  emitGauge("esp_heap_max_block_bytes", "Largest free heap block.",
+            ESP.getMaxFreeBlockSize());
+  emitGauge("esp_heap_fragmentation_percent", "Heap fragmentation.",
+            ESP.getHeapFragmentation());
+  emitGauge("esp_loop_iterations_per_second",
+            "loop() passes during the last second.", loopsLastSecond);
+  emitCounter("esp_loop_iterations_total", "loop() passes since boot.",
+              loopCount);
+  emitGauge("esp_loop_max_us", "Slowest loop() pass in microseconds.",
+            schedulerLoopMaxUs());
+
+  emitHeader("esp_task_runs_total", "counter", "Scheduler task runs.");
+  for (int i = 0; i < schedulerTaskCount(); i++)
+    emit("esp_task_runs_total{task=\"%s\"} %lu\n", schedulerTask(i).name,
+         (unsigned long)schedulerTask(i).runs);
+  emitHeader("esp_task_max_us", "gauge", "Slowest run per task.");
+  for (int i = 0; i < schedulerTaskCount(); i++)
+    emit("esp_task_max_us{task=\"%s\"} %lu\n", schedulerTask(i).name,
+         (unsigned long)schedulerTask(i).maxUs);
+
+  emitHeader("esp_http_request_duration_seconds", "histogram",
+             "Handler latency per route.");
+  char labels[64];
+  for (int i = 0; i < routeCount; i++) {
+    snprintf(labels, sizeof(labels), "route=\"%s\",method=\"%s\"",
+             routes[i].uri, routes[i].method);
+    emitHistogram("esp_http_request_duration_seconds", labels,
+                  routes[i].latency, routeBounds, 1000000);
+  }
+
+  emitHeader("esp_rpc_duration_seconds", "histogram",
+             "Transmission RPC round trip, including handshakes.");
+  emitHistogram("esp_rpc_duration_seconds", "", rpcLatency, rpcBounds, 1000);
+  emitGauge("esp_rpc_last_round_trip_ms",
+            "Last successful Transmission RPC, handshakes included.",
+            speedMonitorClient().roundTripMs());
+  emitGauge("esp_rpc_peak_heap_bytes",
+            "Largest heap drop while the last RPC was in flight.",
+            speedMonitorClient().peakHeapUsed());
+
+  emitCounter("esp_tft_windows_total", "Address windows set on the TFT.",
+              displayTraffic.windows);
+  emitCounter("esp_tft_pixels_pushed_total", "Pixels written to the TFT.",
+              displayTraffic.pixels);
+  emitCounter("esp_tft_bytes_pushed_total",
+              "SPI bytes sent to the TFT, pixels plus window framing.",
+              displayTraffic.bytes);
+  emitHeader("esp_tft_spi_seconds_total", "counter",
+             "SPI bus time of those bytes at the configured frequency.");
+  emit("esp_tft_spi_seconds_total ");
+  emitSeconds(displaySpiMicros(displayTraffic.bytes), 1000000);
+  emit("\n");
+  emitGauge("esp_tft_frame_windows",
+            "SPI windows of the last compositor flush.",
+            compositorFrameWindows());
+  emitGauge("esp_tft_frame_bytes", "SPI bytes of the last compositor flush.",
+            compositorFrameBytes());
+  emitGauge("esp_status_bar_last_bytes",
+            "Pixel bytes sent by the last status bar update.",
+            statusBarLastBytes);
+  emitCounter("esp_status_bar_bytes_total",
+              "Pixel bytes sent by status bar updates.", statusBarBytesPushed);
+  emitCounter("esp_status_bar_updates_total",
+              "Status bar updates that reached the panel.", statusBarUpdates);
+
+  emitGauge("esp_torrents", "Torrents on the Transmission server.",
+            torrentTotal());
+  emitGauge("esp_torrents_tracked", "Torrents in the local table.",
+            torrentCount());
+  emitGauge("esp_torrent_poll_rows", "Torrent rows in the last reply.",
+            torrentLastRows());
+  emitCounter("esp_torrent_syncs_total",
+              "Full torrent list syncs, the first one included.",
+              torrentSyncCount());
+
+  emitGauge("esp_wifi_rssi_dbm", "Signal strength.", WiFi.RSSI());
+  emitGauge("esp_wifi_connect_ms", "Boot to first connection.",
+            wifiConnectTime());
+  emitCounter("esp_wifi_reconnects_total", "Reconnects after link loss.",
+              wifiReconnectCount());
+  emitGauge("esp_wifi_last_reconnect_ms", "Last link loss to reconnect.",
+            wifiLastReconnectTime());
+  emitCounter("esp_wifi_failovers_total", "Failovers to another network.",
+              wifiFailoverCount());
+  emitCounter("esp_wifi_roams_total", "Roams to a stronger AP.",
+              wifiRoamCount());
+
+  emitCounter("esp_stalls_total", "Tasks or handlers over the stall threshold.",
+              stallCount());
+  emitGauge("esp_last_stall_ms", "Duration of the last stall.", stallLastMs());
+  emitGauge("esp_reset_reason", "rst_info reason code of the last reset.",
+            postMortemResetReason());
+  if (postMortemValid()) {
+    const PostMortem &pm = postMortem();
+    emitHeader("esp_postmortem_duration_ms", "gauge",
+               "What was running before the last reset, and for how long.");
+    emit("esp_postmortem_duration_ms{reason=\"%s\",kind=\"%s\",task=\"%s\","
+         "exccause=\"%u\",epc=\"0x%08lx\"} %lu\n",
+         postMortemReasonName(), pm.kind == PM_CRASH ? "crash" : "stall",
+         pm.task, pm.exccause, (unsigned long)pm.epc,
+         (unsigned long)pm.durationMs);
+  }
+
+  flush();
+  server.sendContent(""); // terminating chunk
+  out = nullptr;
+}
+
+#endif
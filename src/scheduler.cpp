@@ -0,0 +1,97 @@
+#include "scheduler.h"
+
+#include "stall_monitor.h"
+#include "trace.h"
+
+static TaskInfo tasks[SCHED_MAX_TASKS];
+static int taskCount = 0;
+static uint32_t loopMaxUs = 0;
+
+int schedulerAdd(const char *name, TaskFn fn, uint32_t periodMs,
+                 uint32_t budgetUs) {
+  if (taskCount >= SCHED_MAX_TASKS)
+    return -1;
+  TaskInfo &t = tasks[taskCount];
+  memset(&t, 0, sizeof(t));
+  t.name = name;
+  t.fn = fn;
+  t.period = periodMs;
+  t.budget = budgetUs;
+  t.due = millis();
+  t.traceId = traceRegister(name);
+  return taskCount++;
+}
+
+void schedulerRun() {
+  // A linear scan in registration order: with a dozen tasks it is cheaper
+  // than keeping a heap or timer wheel ordered, and the order is predictable
+  uint32_t loopStart = micros();
+  for (int i = 0; i < taskCount; i++) {
+    TaskInfo &t = tasks[i];
+    unsigned long now = millis();
+    long late = (long)(now - t.due);
+    if (late < 0)
+      continue;
+
+    if (t.period) {
+      if ((unsigned long)late >= t.period) {
+        t.missed++;
+        t.due = now + t.period; // skip the backlog instead of bursting
+      } else {
+        t.due += t.period;
+      }
+    }
+
+    uint32_t start = micros();
+    TRACE_BEGIN(t.traceId);
+    {
+      StallScope stall(t.name);
+      t.fn();
+    }
+    TRACE_END(t.traceId);
+    uint32_t took = micros() - start;
+
+    t.runs++;
+    t.totalUs += took;
+    if (took > t.maxUs)
+      t.maxUs = took;
+    if (t.budget && took > t.budget)
+      t.overBudget++;
+  }
+
+  uint32_t took = micros() - loopStart;
+  if (took > loopMaxUs)
+    loopMaxUs = took;
+  stallCheckLoop(took);
+}
+
+int schedulerTaskCount() { return taskCount; }
+
+const TaskInfo &schedulerTask(int i) { return tasks[i]; }
+
+uint32_t schedulerLoopMaxUs() { return loopMaxUs; }
+
+void schedulerHandleStats(ESP8266WebServer &server) {
+  server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+  server.send(200, "application/json", "");
+
+  char buf[192];
+  int len = snprintf(buf, sizeof(buf), "{\"loop_max_us\":%lu,\"tasks\":[",
+                     (unsigned long)loopMaxUs);
+  server.sendContent(buf, len);
+  for (int i = 0; i < taskCount; i++) {
+    const TaskInfo &t = tasks[i];
+    len = snprintf(buf, sizeof(buf),
+                   "%s{\"name\":\"%s\",\"period_ms\":%lu,\"budget_us\":%lu,"
+                   "\"runs\":%lu,\"avg_us\":%lu,\"max_us\":%lu,"
+                   "\"over_budget\":%lu,\"missed\":%lu}",
+                   i ? "," : "", t.name, (unsigned long)t.period,
+                   (unsigned long)t.budget, (unsigned long)t.runs,
+                   (unsigned long)(t.runs ? t.totalUs / t.runs : 0),
+                   (unsigned long)t.maxUs, (unsigned long)t.overBudget,
+                   (unsigned long)t.missed);
+    server.sendContent(buf, len);
+  }
+  server.sendContent("]}");
+  server.sendContent(""); // terminating chunk
+}
@@ -0,0 +1,116 @@
+#include "settings.h"
+
+Settings settings;
+
+void settingsDefaults(Settings &s) {
+  memset(&s, 0, sizeof(s));
+  s.trans.port = SETTINGS_DEFAULT_PORT;
+  strlcpy(s.trans.path, SETTINGS_DEFAULT_PATH, sizeof(s.trans.path));
+  s.trans.poll = SETTINGS_DEFAULT_POLL;
+}
+
+void settingsCopyText(char *field, const char *value, size_t size) {
+  memset(field, 0, size);
+  strlcpy(field, value, size);
+}
+
+// Printable ASCII without spaces for hosts/paths, any printable for the rest
+static bool validText(const char *s, bool allowSpace) {
+  for (; *s; s++) {
+    if ((unsigned char)*s < 0x20 || *s == 0x7F || (!allowSpace && *s == ' '))
+      return false;
+  }
+  return true;
+}
+
+// Copies an arg into a fixed field if present; false if it does not fit
+static bool copyArg(ESP8266WebServer &server, const char *name, char *dst,
+                    size_t size) {
+  if (!server.hasArg(name))
+    return true;
+  const String &value = server.arg(name);
+  if (value.length() >= size)
+    return false;
+  settingsCopyText(dst, value.c_str(), size);
+  return true;
+}
+
+const char *settingsAddNetwork(const char *ssid, const char *pass) {
+  size_t passLen = strlen(pass);
+  if (!*ssid || strlen(ssid) >= SETTINGS_SSID_LEN)
+    return "SSID must be 1-32 characters";
+  if (passLen >= SETTINGS_PASS_LEN || (passLen && passLen < 8))
+    return "Password must be empty or 8-64 characters";
+
+  settingsStoreNetwork(ssid, pass);
+  return nullptr;
+}
+
+bool settingsStoreNetwork(const char *ssid, const char *pass) {
+  if (!*ssid)
+    return false;
+  settingsForgetNetwork(ssid);
+  int last = min((int)settings.networkCount, SETTINGS_MAX_NETWORKS - 1);
+  memmove(&settings.networks[1], &settings.networks[0],
+          last * sizeof(WifiNetwork));
+  settingsCopyText(settings.networks[0].ssid, ssid, SETTINGS_SSID_LEN);
+  settingsCopyText(settings.networks[0].pass, pass, SETTINGS_PASS_LEN);
+  if (settings.networkCount < SETTINGS_MAX_NETWORKS)
+    settings.networkCount++;
+  return true;
+}
+
+bool settingsForgetNetwork(const char *ssid) {
+  for (int i = 0; i < settings.networkCount; i++) {
+    if (strcmp(settings.networks[i].ssid, ssid) != 0)
+      continue;
+    memmove(&settings.networks[i], &settings.networks[i + 1],
+            (settings.networkCount - i - 1) * sizeof(WifiNetwork));
+    settings.networkCount--;
+    memset(&settings.networks[settings.networkCount], 0, sizeof(WifiNetwork));
+    return true;
+  }
+  return false;
+}
+
+const char *settingsParseTransmission(TransmissionSettings &t,
+                                      ESP8266WebServer &server) {
+  TransmissionSettings n = t;
+
+  if (!copyArg(server, "host", n.host, sizeof(n.host)) ||
+      !validText(n.host, false))
+    return "Host invalid";
+  if (!copyArg(server, "path", n.path, sizeof(n.path)) ||
+      !validText(n.path, false))
+    return "Path invalid";
+  if (!n.path[0])
+    settingsCopyText(n.path, SETTINGS_DEFAULT_PATH, sizeof(n.path));
+  else if (n.path[0] != '/')
+    return "Path invalid";
+  if (!copyArg(server, "user", n.user, sizeof(n.user)) ||
+      !validText(n.user, true))
+    return "Username invalid";
+  if (!copyArg(server, "pass", n.pass, sizeof(n.pass)) ||
+      !validText(n.pass, true))
+    return "Password invalid";
+
+  if (server.hasArg("port")) {
+    long port = server.arg("port").toInt();
+    if (server.arg("port") == "")
+      port = SETTINGS_DEFAULT_PORT;
+    if (port < 1 || port > 65535)
+      return "Port invalid";
+    n.port = port;
+  }
+  if (server.hasArg("poll")) {
+    long poll = server.arg("poll").toInt();
+    if (server.arg("poll") == "")
+      poll = SETTINGS_DEFAULT_POLL;
+    if (poll < 1 || poll > 255)
+      return "Poll interval invalid";
+    n.poll = poll;
+  }
+
+  t = n;
+  return nullptr;
+}
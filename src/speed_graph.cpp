@@ -0,0 +1,150 @@
+#include "speed_graph.h"
+
+#include "compositor.h"
+#include "display_utils.h"
+
+#define GRAPH_DOWN_COLOR TFT_GREEN
+#define GRAPH_UP_COLOR TFT_CYAN
+#define GRAPH_CURSOR_COLOR TFT_DARKGREY
+#define GRAPH_MIN_SCALE (10 * 1024UL) // 10 KB/s
+
+// Sliding-window maximum: a monotonic deque of sample sequence numbers whose
+// values decrease from front to back, so the front is always the window max.
+// Each sample is pushed and popped at most once, so updates are O(1)
+// amortized instead of a rescan of the whole window.
+struct MaxWindow {
+  uint16_t seq[SPEED_HISTORY];
+  int front;
+  int size;
+};
+
+static MaxWindow downWindow;
+static MaxWindow upWindow;
+static uint32_t newestSeq = 0;
+static uint32_t scale = GRAPH_MIN_SCALE;
+
+// Widgets on the connected screen
+static int labelWidget = -1;
+static int graphWidget = -1;
+
+static uint32_t sampleValue(uint16_t seq, bool up) {
+  const SpeedSample &s = speedHistory((uint16_t)((uint16_t)newestSeq - seq));
+  return up ? s.up : s.down;
+}
+
+static void windowPush(MaxWindow &w, uint16_t seq, bool up) {
+  // At most one sample slides out of the window per push
+  if (w.size && (uint16_t)(seq - w.seq[w.front]) >= SPEED_HISTORY) {
+    w.front = (w.front + 1) % SPEED_HISTORY;
+    w.size--;
+  }
+
+  uint32_t value = sampleValue(seq, up);
+  while (w.size) {
+    int back = (w.front + w.size - 1) % SPEED_HISTORY;
+    if (sampleValue(w.seq[back], up) > value)
+      break;
+    w.size--;
+  }
+  w.seq[(w.front + w.size) % SPEED_HISTORY] = seq;
+  w.size++;
+}
+
+static uint32_t windowMax(const MaxWindow &w, bool up) {
+  return w.size ? sampleValue(w.seq[w.front], up) : 0;
+}
+
+// Rounds up to 1/2/5 x 10^n KB/s so the scale only changes on big swings
+static uint32_t niceScale(uint32_t value) {
+  for (uint32_t step = GRAPH_MIN_SCALE; step < 0x7FFFFFFF / 5; step *= 10) {
+    if (value <= step)
+      return step;
+    if (value <= step * 2)
+      return step * 2;
+    if (value <= step * 5)
+      return step * 5;
+  }
+  return 0x7FFFFFFF;
+}
+
+static int barHeight(uint32_t value) {
+  return (int)((uint64_t)value * GRAPH_H / scale);
+}
+
+static void drawColumn(TFT_eSPI &gfx, int x, const SpeedSample &s) {
+  int bottom = GRAPH_Y + GRAPH_H;
+  int hd = barHeight(s.down);
+  int hu = barHeight(s.up);
+
+  // The compositor has already filled the background
+  if (hd > 0)
+    gfx.drawFastVLine(x, bottom - hd, hd, GRAPH_DOWN_COLOR);
+
+  // Upload is drawn as a 2 px trace on top of the download area
+  if (hu > 0)
+    gfx.drawFastVLine(x, bottom - hu, hu > 1 ? 2 : 1, GRAPH_UP_COLOR);
+}
+
+// Custom widget body: only the columns inside the clip are drawn
+static void renderGraph(TFT_eSPI &gfx, int ox, int oy,
+                        const WidgetClip &clip) {
+  gfx.drawRect(GRAPH_X - 1 + ox, GRAPH_Y - 1 + oy, GRAPH_W + 2, GRAPH_H + 2,
+               TFT_DARKGREY);
+
+  int count = speedHistoryCount();
+  int newestCol = newestSeq % GRAPH_W;
+  int from = max(clip.x - GRAPH_X, 0);
+  int to = min(clip.x + clip.w - GRAPH_X, GRAPH_W);
+  for (int col = from; col < to; col++) {
+    int age = (newestCol - col + GRAPH_W) % GRAPH_W;
+    if (count && col == (newestCol + 1) % GRAPH_W)
+      gfx.drawFastVLine(GRAPH_X + col + ox, GRAPH_Y + oy, GRAPH_H,
+                        GRAPH_CURSOR_COLOR);
+    else if (age < count)
+      drawColumn(gfx, GRAPH_X + col + ox, speedHistory(age));
+  }
+}
+
+static void updateScaleLabel() {
+  char text[24];
+  if (scale >= 1024UL * 1024)
+    snprintf(text, sizeof(text), "Max %lu MB/s",
+             (unsigned long)(scale / (1024UL * 1024)));
+  else
+    snprintf(text, sizeof(text), "Max %lu KB/s",
+             (unsigned long)(scale / 1024));
+  widgetSetText(labelWidget, text);
+}
+
+void speedGraphAdd(uint32_t seq) {
+  newestSeq = seq;
+  windowPush(downWindow, (uint16_t)seq, false);
+  windowPush(upWindow, (uint16_t)seq, true);
+
+  uint32_t newScale =
+      niceScale(max(windowMax(downWindow, false), windowMax(upWindow, true)));
+  bool rescaled = newScale != scale;
+  scale = newScale;
+
+  if (currentScreen != SCREEN_SPEED)
+    return;
+  if (rescaled) {
+    updateScaleLabel();
+    widgetInvalidate(graphWidget);
+    return;
+  }
+
+  // The new column and the cursor after it (widget-relative: +1 border)
+  int col = seq % GRAPH_W;
+  int cursor = (seq + 1) % GRAPH_W;
+  widgetInvalidateRect(graphWidget, col + 1, 1, 1, GRAPH_H);
+  widgetInvalidateRect(graphWidget, cursor + 1, 1, 1, GRAPH_H);
+}
+
+void speedGraphBegin() {
+  labelWidget = widgetLabel(GRAPH_X, GRAPH_Y - 12, 16, 1, TFT_LIGHTGREY,
+                            TFT_BLACK, "");
+  graphWidget = widgetCustom(GRAPH_X - 1, GRAPH_Y - 1, GRAPH_W + 2,
+                             GRAPH_H + 2, renderGraph);
+  updateScaleLabel();
+}
@@ -0,0 +1,116 @@
+#include "speed_monitor.h"
+
+#include "display_utils.h"
+#include "speed_graph.h"
+
+static TransmissionClient monitorClient;
+static StaticJsonDocument<SPEED_STATS_DOC_SIZE> statsResult;
+static StaticJsonDocument<96> statsFilter;
+
+static bool enabled = false;
+static unsigned long pollInterval = SETTINGS_DEFAULT_POLL * 1000UL;
+static unsigned long lastPoll = 0;
+static bool inFlight = false;
+static bool valid = false;
+static uint8_t failures = 0; // in a row, for the backoff
+static char lastError[32] = ""; // logged once until it changes
+
+// Ring buffer of recent samples
+static SpeedSample history[SPEED_HISTORY];
+static int historyHead = 0;
+static int historyCount = 0;
+static uint32_t sampleCount = 0;
+
+// The poll interval, doubled per failure in a row up to SPEED_BACKOFF_MAX
+static unsigned long nextPollDelay() {
+  unsigned long delay = pollInterval;
+  for (uint8_t i = 0; i < failures && delay < SPEED_BACKOFF_MAX; i++)
+    delay = min(delay * 2, (unsigned long)SPEED_BACKOFF_MAX);
+  return delay;
+}
+
+static void logFailure(const String &error) {
+  if (strcmp(error.c_str(), lastError) == 0)
+    return;
+  strlcpy(lastError, error.c_str(), sizeof(lastError));
+  Serial.print("Speed poll failed: ");
+  Serial.println(error);
+}
+
+void speedMonitorConfigure(const TransmissionSettings &target) {
+  monitorClient.reset();
+  inFlight = false;
+  monitorClient.configure(target);
+  enabled = target.host[0] != '\0';
+  pollInterval =
+      (target.poll > 0 ? target.poll : SETTINGS_DEFAULT_POLL) * 1000UL;
+  lastPoll = millis() - pollInterval; // poll as soon as we are connected
+  failures = 0;
+  lastError[0] = '\0';
+
+  statsFilter.clear();
+  statsFilter["arguments"]["downloadSpeed"] = true;
+  statsFilter["arguments"]["uploadSpeed"] = true;
+}
+
+void speedMonitorLoop() {
+  if (!enabled || currentState != STATE_CONNECTED) {
+    if (inFlight || valid)
+      monitorClient.reset(); // also drops the keep-alive socket
+    inFlight = false;
+    valid = false;
+    return;
+  }
+
+  monitorClient.poll();
+
+  if (inFlight && monitorClient.finished()) {
+    inFlight = false;
+    if (monitorClient.state() == RPC_DONE) {
+      SpeedSample &s = history[historyHead];
+      s.down = statsResult["arguments"]["downloadSpeed"] | 0UL;
+      s.up = statsResult["arguments"]["uploadSpeed"] | 0UL;
+      historyHead = (historyHead + 1) % SPEED_HISTORY;
+      if (historyCount < SPEED_HISTORY)
+        historyCount++;
+      sampleCount++;
+      valid = true;
+      speedGraphAdd(sampleCount - 1);
+      if (failures)
+        Serial.printf("Speed poll recovered after %u failures\n",
+                      (unsigned)failures);
+      failures = 0;
+      lastError[0] = '\0';
+    } else {
+      logFailure(monitorClient.error());
+      valid = false;
+      if (failures < UINT8_MAX)
+        failures++;
+    }
+    monitorClient.release();
+    drawSpeedView(valid, speedLatest().down, speedLatest().up);
+  }
+
+  // Waits while the torrent list has a request on the client
+  if (!inFlight && monitorClient.idle() &&
+      millis() - lastPoll >= nextPollDelay()) {
+    lastPoll = millis();
+    inFlight = monitorClient.start("{\"method\":\"session-stats\"}",
+                                   statsResult, &statsFilter);
+  }
+}
+
+bool speedMonitorValid() { return valid; }
+
+const SpeedSample &speedLatest() { return speedHistory(0); }
+
+int speedHistoryCount() { return historyCount; }
+
+uint32_t speedSampleCount() { return sampleCount; }
+
+const SpeedSample &speedHistory(int age) {
+  int i = (historyHead - 1 - age + 2 * SPEED_HISTORY) % SPEED_HISTORY;
+  return history[i];
+}
+
+TransmissionClient &speedMonitorClient() { return monitorClient; }
@@ -0,0 +1,137 @@
+#include "stall_monitor.h"
+
+#include <coredecls.h>
+#include <user_interface.h>
+
+static const char *activity = "setup";
+static unsigned long activitySince = 0;
+
+static uint32_t stalls = 0;
+static uint32_t lastStallMs = 0;
+static uint32_t stallsAtPassStart = 0;
+
+static PostMortem previous;
+static bool previousValid = false;
+static uint32_t resetReason = REASON_DEFAULT_RST;
+
+static uint32_t recordCrc(const PostMortem &pm) {
+  return crc32((const uint8_t *)&pm + sizeof(pm.crc),
+               sizeof(pm) - sizeof(pm.crc));
+}
+
+static void writeRecord(PostMortemKind kind, const char *task,
+                        uint32_t durationMs, uint32_t epc, uint8_t exccause) {
+  PostMortem pm;
+  memset(&pm, 0, sizeof(pm));
+  pm.kind = kind;
+  pm.durationMs = durationMs;
+  pm.uptimeS = millis() / 1000;
+  pm.epc = epc;
+  pm.exccause = exccause;
+  strlcpy(pm.task, task, sizeof(pm.task));
+  pm.crc = recordCrc(pm);
+  ESP.rtcUserMemoryWrite(STALL_RTC_OFFSET, (uint32_t *)&pm, sizeof(pm));
+}
+
+static void recordStall(const char *task, uint32_t ms) {
+  stalls++;
+  lastStallMs = ms;
+  writeRecord(PM_STALL, task, ms, 0, 0);
+  Serial.printf("Stall: %s took %lu ms\n", task, (unsigned long)ms);
+}
+
+void stallMonitorBegin() {
+  resetReason = ESP.getResetInfoPtr()->reason;
+  previousValid =
+      ESP.rtcUserMemoryRead(STALL_RTC_OFFSET, (uint32_t *)&previous,
+                            sizeof(previous)) &&
+      previous.crc == recordCrc(previous) && previous.kind != PM_NONE;
+
+  // Report it once: the next boot starts clean
+  PostMortem empty;
+  memset(&empty, 0, sizeof(empty));
+  ESP.rtcUserMemoryWrite(STALL_RTC_OFFSET, (uint32_t *)&empty, sizeof(empty));
+
+  if (previousValid)
+    Serial.printf("Previous reset: %s, %s in %s (%lu ms)\n",
+                  postMortemReasonName(),
+                  previous.kind == PM_CRASH ? "crash" : "stall", previous.task,
+                  (unsigned long)previous.durationMs);
+}
+
+void stallCheckLoop(uint32_t us) {
+  // A slow pass is only reported as "loop" when no single task explains it
+  if (us / 1000 > STALL_THRESHOLD_MS && stalls == stallsAtPassStart)
+    recordStall("loop", us / 1000);
+  stallsAtPassStart = stalls;
+}
+
+StallScope::StallScope(const char *name)
+    : prevName(activity), prevSince(activitySince), stallsAtStart(stalls) {
+  activity = name;
+  activitySince = millis();
+}
+
+StallScope::~StallScope() {
+  // Already attributed when an inner scope recorded it
+  uint32_t ms = millis() - activitySince;
+  if (ms > STALL_THRESHOLD_MS && stalls == stallsAtStart)
+    recordStall(activity, ms);
+  activity = prevName;
+  activitySince = prevSince;
+}
+
+// Called by the core's postmortem handler on exceptions and software
+// watchdog resets, before the reboot
+extern "C" void custom_crash_callback(struct rst_info *info, uint32_t stack,
+                                      uint32_t stackEnd) {
+  (void)stack;
+  (void)stackEnd;
+  writeRecord(PM_CRASH, activity, millis() - activitySince, info->epc1,
+              info->exccause);
+}
+
+uint32_t stallCount() { return stalls; }
+
+uint32_t stallLastMs() { return lastStallMs; }
+
+bool postMortemValid() { return previousValid; }
+
+const PostMortem &postMortem() { return previous; }
+
+uint32_t postMortemResetReason() { return resetReason; }
+
+const char *postMortemReasonName() {
+  switch (resetReason) {
+  case REASON_DEFAULT_RST:
+    return "power on";
+  case REASON_WDT_RST:
+    return "hardware watchdog";
+  case REASON_EXCEPTION_RST:
+    return "exception";
+  case REASON_SOFT_WDT_RST:
+    return "software watchdog";
+  case REASON_SOFT_RESTART:
+    return "restart";
+  case REASON_DEEP_SLEEP_AWAKE:
+    return "deep sleep";
+  case REASON_EXT_SYS_RST:
+    return "reset pin";
+  default:
+    return "unknown";
+  }
+}
+
+size_t postMortemSummary(char *buf, size_t size) {
+  int len = 0;
+  if (previousValid) {
+    len = snprintf(buf, size, "%s: %s %s %lums", postMortemReasonName(),
+                   previous.task,
+                   previous.kind == PM_CRASH ? "crashed" : "stalled",
+                   (unsigned long)previous.durationMs);
+  } else if (resetReason == REASON_WDT_RST) {
+    // The hardware watchdog resets without running any handler
+    len = snprintf(buf, size, "Reset: %s", postMortemReasonName());
+  }
+  return len < 0 ? 0 : min((size_t)len, size - 1);
+}
@@ -0,0 +1,62 @@
+#include "template_renderer.h"
+
+#define TEMPLATE_VALUE_MAX 64
+
+// Escapes value into out; returns the escaped length
+static size_t htmlEscape(const char *value, size_t len, char *out,
+                         size_t size) {
+  size_t n = 0;
+  for (size_t i = 0; i < len; i++) {
+    const char *rep = nullptr;
+    switch (value[i]) {
+    case '&':
+      rep = "&amp;";
+      break;
+    case '<':
+      rep = "&lt;";
+      break;
+    case '>':
+      rep = "&gt;";
+      break;
+    case '"':
+      rep = "&quot;";
+      break;
+    case '\'':
+      rep = "&#39;";
+      break;
+    }
+    size_t repLen = rep ? strlen(rep) : 1;
+    if (n + repLen >= size)
+      break;
+    if (rep) {
+      memcpy(out + n, rep, repLen);
+    } else {
+      out[n] = value[i];
+    }
+    n += repLen;
+  }
+  return n;
+}
+
+void streamTemplate(ESP8266WebServer &server, const PageTemplate &tpl,
+                    TemplateSlotFn slotValue) {
+  server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+  server.send(200, "text/html", "");
+
+  char value[TEMPLATE_VALUE_MAX];
+  char escaped[TEMPLATE_VALUE_MAX * 2];
+  for (uint8_t i = 0; i < tpl.count; i++) {
+    server.sendContent_P(tpl.segments[i]);
+
+    uint8_t slot = tpl.slots[i];
+    if (slot == 0xFF)
+      continue;
+    size_t len = slotValue(slot, value, sizeof(value));
+    if (len >= sizeof(value))
+      len = sizeof(value) - 1;
+    len = htmlEscape(value, len, escaped, sizeof(escaped));
+    if (len)
+      server.sendContent(escaped, len);
+  }
+  server.sendContent(""); // terminating chunk
+}
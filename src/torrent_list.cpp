@@ -0,0 +1,469 @@
+#include "torrent_list.h"
+
+#include "display_utils.h"
+#include "speed_monitor.h"
+
+// Fields the table keeps; deltas leave out the name, which never changes
+#define TORRENT_FIELDS                                                        \
+  "\"id\",\"percentDone\",\"rateDownload\",\"rateUpload\",\"eta\",\"status\""
+#define TORRENT_PAYLOAD_LEN 320
+
+enum SyncState : uint8_t {
+  SYNC_COUNT,   // session-stats: how many torrents to page through
+  SYNC_PAGE,    // torrent-get by explicit id ranges
+  SYNC_RECOUNT, // session-stats again after a run of empty pages
+  SYNC_DELTA    // torrent-get "recently-active"
+};
+
+static DynamicJsonDocument *listResult = nullptr; // only while enabled
+static StaticJsonDocument<64> countFilter;
+// arguments: torrents' first element with its seven fields, and removed
+static StaticJsonDocument<JSON_OBJECT_SIZE(1) + JSON_OBJECT_SIZE(2) +
+                          JSON_ARRAY_SIZE(1) + JSON_OBJECT_SIZE(7)>
+    listFilter;
+static char payload[TORRENT_PAYLOAD_LEN]; // must outlive the request
+
+static const char deltaPayload[] =
+    "{\"method\":\"torrent-get\",\"arguments\":{\"fields\":[" TORRENT_FIELDS
+    "],\"ids\":\"recently-active\"}}";
+
+static bool enabled = false;
+static bool inFlight = false;
+static bool synced = false;
+static bool deltaFits = true; // false: syncs stand in for deltas, paced
+static SyncState syncState = SYNC_COUNT;
+static unsigned long lastPoll = 0;
+static unsigned long lastDelta = 0; // last merged delta or finished sync
+
+// Sync progress
+static uint32_t total = 0;
+static uint32_t nextId = 1;
+static uint32_t found = 0;
+static uint8_t gap = 0;
+static uint8_t pageSize = TORRENT_PAGE; // halved for replies too big
+static uint32_t syncSeq = 0; // first poll of the running sync
+
+// Names asked for by the request in flight, if it is a name fetch
+static uint32_t nameIds[TORRENT_PAGE];
+static int nameCount = 0;
+
+// Sorted most active first
+static TorrentInfo table[TORRENT_MAX];
+static int count = 0;
+static uint32_t pollSeq = 0;
+static uint32_t changes = 0;
+
+static uint16_t lastRows = 0;
+static unsigned long syncs = 0;
+
+// --- Table ---
+
+static bool moreActive(const TorrentInfo &a, const TorrentInfo &b) {
+  uint32_t rateA = a.down + a.up, rateB = b.down + b.up;
+  if (rateA != rateB)
+    return rateA > rateB;
+  bool doneA = a.permille >= 1000, doneB = b.permille >= 1000;
+  if (doneA != doneB)
+    return doneB; // unfinished first
+  if (a.seen != b.seen)
+    return a.seen > b.seen;
+  return a.id < b.id;
+}
+
+// Restores the order after one entry changed; returns where it ended up
+static int settle(int i) {
+  TorrentInfo t = table[i];
+  while (i > 0 && moreActive(t, table[i - 1])) {
+    table[i] = table[i - 1];
+    i--;
+  }
+  while (i < count - 1 && moreActive(table[i + 1], t)) {
+    table[i] = table[i + 1];
+    i++;
+  }
+  table[i] = t;
+  return i;
+}
+
+static int findTorrent(uint32_t id) {
+  for (int i = 0; i < count; i++) {
+    if (table[i].id == id)
+      return i;
+  }
+  return -1;
+}
+
+static void removeAt(int i) {
+  memmove(&table[i], &table[i + 1], (count - i - 1) * sizeof(TorrentInfo));
+  count--;
+  changes++;
+}
+
+// Everything shown but the order
+static bool sameRow(const TorrentInfo &a, const TorrentInfo &b) {
+  return a.down == b.down && a.up == b.up && a.eta == b.eta &&
+         a.permille == b.permille && a.status == b.status &&
+         strcmp(a.name, b.name) == 0;
+}
+
+// Truncates without splitting a UTF-8 sequence; control characters
+// become spaces so the name is safe on the panel
+static void copyName(char *out, const char *name) {
+  size_t n = strnlen(name, TORRENT_NAME_LEN);
+  if (n == TORRENT_NAME_LEN) {
+    n = TORRENT_NAME_LEN - 1;
+    while (n && ((uint8_t)name[n] & 0xC0) == 0x80)
+      n--;
+  }
+  for (size_t i = 0; i < n; i++)
+    out[i] = (uint8_t)name[i] < 0x20 ? ' ' : name[i];
+  out[n] = '\0';
+}
+
+static void mergeTorrent(JsonObjectConst t) {
+  TorrentInfo info = {};
+  info.id = t["id"] | 0UL;
+  if (!info.id)
+    return;
+  info.down = t["rateDownload"] | 0UL;
+  info.up = t["rateUpload"] | 0UL;
+  info.eta = t["eta"] | -1L;
+  float done = t["percentDone"] | 0.0f;
+  info.permille = constrain((long)(done * 1000 + 0.5f), 0L, 1000L);
+  info.status = t["status"] | 0;
+  info.seen = pollSeq;
+
+  int i = findTorrent(info.id);
+  const char *name = t["name"];
+  if (name)
+    copyName(info.name, name);
+  else if (i >= 0)
+    memcpy(info.name, table[i].name, sizeof(info.name));
+
+  bool same = i >= 0 && sameRow(info, table[i]);
+  if (i < 0) {
+    if (count < TORRENT_MAX) {
+      i = count++;
+    } else {
+      // Full: the least active one makes room, unless this one is less so
+      i = count - 1;
+      if (!moreActive(info, table[i]))
+        return;
+    }
+  }
+  table[i] = info;
+  if (settle(i) != i || !same)
+    changes++;
+}
+
+// Merges one torrent-get reply; returns the rows it carried
+static uint16_t mergeReply() {
+  pollSeq++;
+  JsonArrayConst torrents = (*listResult)["arguments"]["torrents"];
+  for (JsonObjectConst t : torrents)
+    mergeTorrent(t);
+  JsonArrayConst removed = (*listResult)["arguments"]["removed"];
+  for (JsonVariantConst id : removed) {
+    int i = findTorrent(id.as<uint32_t>());
+    if (i >= 0)
+      removeAt(i);
+  }
+  return torrents.size();
+}
+
+// --- Requests ---
+
+static int formatIds(const uint32_t *ids, int n) {
+  int len = snprintf(payload, sizeof(payload),
+                     "{\"method\":\"torrent-get\",\"arguments\":{\"fields\":["
+                     "\"name\"," TORRENT_FIELDS "],\"ids\":[");
+  for (int i = 0; i < n; i++)
+    len += snprintf(payload + len, sizeof(payload) - len, "%s%lu",
+                    i ? "," : "", (unsigned long)ids[i]);
+  len += snprintf(payload + len, sizeof(payload) - len, "]}}");
+  return len;
+}
+
+// Names of torrents first seen in a delta, a page at a time
+static bool startNames() {
+  nameCount = 0;
+  for (int i = 0; i < count && nameCount < pageSize; i++) {
+    if (!table[i].name[0])
+      nameIds[nameCount++] = table[i].id;
+  }
+  if (!nameCount)
+    return false;
+  formatIds(nameIds, nameCount);
+  inFlight = speedMonitorClient().start(payload, *listResult, &listFilter);
+  return true;
+}
+
+static void finishNames() {
+  mergeReply();
+  // Still nameless: removed between the delta and this request
+  for (int n = 0; n < nameCount; n++) {
+    int i = findTorrent(nameIds[n]);
+    if (i >= 0 && !table[i].name[0])
+      removeAt(i);
+  }
+  nameCount = 0;
+  drawTorrentView();
+}
+
+static void startSync() {
+  if (synced)
+    changes++;
+  syncState = SYNC_COUNT;
+  synced = false;
+  nameCount = 0;
+}
+
+static void finishSync() {
+  // Entries this sync did not report are gone from the server
+  for (int i = count - 1; i >= 0; i--) {
+    if (table[i].seen < syncSeq)
+      removeAt(i);
+  }
+  syncState = SYNC_DELTA;
+  synced = true;
+  changes++;
+  lastDelta = millis();
+  drawTorrentView();
+}
+
+// A reply too big for the document is asked for again in halves. A single
+// torrent that still does not fit is left out of the sync, or keeps its id
+// for a name, so it is not asked for on every poll.
+static void replyTooLarge() {
+  if (nameCount > 1 || (syncState == SYNC_PAGE && pageSize > 1)) {
+    pageSize = max(1, (nameCount > 1 ? nameCount : pageSize) / 2);
+  } else if (nameCount) {
+    int i = findTorrent(nameIds[0]);
+    if (i >= 0) {
+      snprintf(table[i].name, TORRENT_NAME_LEN, "#%lu",
+               (unsigned long)nameIds[0]);
+      changes++;
+    }
+  } else if (syncState == SYNC_PAGE) {
+    Serial.printf("Torrent %lu skipped\n", (unsigned long)nextId);
+    nextId++;
+    found++;
+  } else {
+    // More active torrents than one delta holds: syncs page through them
+    deltaFits = false;
+    startSync();
+  }
+  nameCount = 0;
+}
+
+static void startRequest() {
+  TransmissionClient &client = speedMonitorClient();
+  switch (syncState) {
+  case SYNC_COUNT:
+  case SYNC_RECOUNT:
+    inFlight = client.start("{\"method\":\"session-stats\"}", *listResult,
+                            &countFilter);
+    break;
+  case SYNC_PAGE: {
+    uint32_t ids[TORRENT_PAGE];
+    for (int i = 0; i < pageSize; i++)
+      ids[i] = nextId + i;
+    formatIds(ids, pageSize);
+    inFlight = client.start(payload, *listResult, &listFilter);
+    break;
+  }
+  case SYNC_DELTA:
+    if (!startNames())
+      inFlight = client.start(deltaPayload, *listResult, &listFilter);
+    break;
+  }
+}
+
+static void finishRequest() {
+  TransmissionClient &client = speedMonitorClient();
+  if (client.state() != RPC_DONE) {
+    Serial.print("Torrent poll failed: ");
+    Serial.println(client.error());
+    if (client.tooLarge())
+      replyTooLarge();
+    else if (syncState != SYNC_DELTA)
+      startSync(); // a sync starts over; a delta retries until it is stale
+    nameCount = 0;
+    return;
+  }
+  if (nameCount) {
+    finishNames();
+    return;
+  }
+
+  uint32_t counted = (*listResult)["arguments"]["torrentCount"] | 0UL;
+  switch (syncState) {
+  case SYNC_COUNT:
+    syncs++;
+    nextId = 1;
+    found = 0;
+    gap = 0;
+    syncSeq = pollSeq + 1;
+    lastRows = 0;
+    // fall through
+  case SYNC_RECOUNT:
+    if (counted != total)
+      changes++;
+    total = counted;
+    syncState = SYNC_PAGE;
+    if (found >= total)
+      finishSync();
+    break;
+  case SYNC_PAGE:
+    lastRows = mergeReply();
+    found += lastRows;
+    nextId += pageSize;
+    if (pageSize < TORRENT_PAGE)
+      pageSize = min(TORRENT_PAGE, pageSize * 2);
+    // Ids are never reused, so deleted torrents leave gaps in the range;
+    // the count is checked again in case some went while paging
+    gap = lastRows ? 0 : gap + 1;
+    if (found >= total) {
+      finishSync();
+    } else if (gap >= TORRENT_RECOUNT_GAP) {
+      gap = 0;
+      syncState = SYNC_RECOUNT;
+    }
+    break;
+  case SYNC_DELTA:
+    lastRows = mergeReply();
+    lastDelta = millis();
+    deltaFits = true;
+    drawTorrentView();
+    break;
+  }
+}
+
+// --- Public API ---
+
+void torrentListConfigure(const TransmissionSettings &target) {
+  inFlight = false; // speedMonitorConfigure() reset the shared client
+  enabled = target.host[0] != '\0';
+  count = 0;
+  total = 0;
+  changes++;
+  deltaFits = true;
+  pageSize = TORRENT_PAGE;
+  startSync();
+
+  // The reply document only takes heap while there is a server to ask
+  if (!enabled) {
+    delete listResult;
+    listResult = nullptr;
+    return;
+  }
+  if (!listResult)
+    listResult = new DynamicJsonDocument(TORRENT_DOC_SIZE);
+  if (!listResult || !listResult->capacity()) {
+    Serial.println("Torrent list: out of memory");
+    enabled = false;
+  }
+
+  countFilter.clear();
+  countFilter["arguments"]["torrentCount"] = true;
+
+  // The first element filters every element of the array
+  listFilter.clear();
+  JsonObject fields = listFilter["arguments"]["torrents"].createNestedObject();
+  fields["id"] = true;
+  fields["name"] = true;
+  fields["percentDone"] = true;
+  fields["rateDownload"] = true;
+  fields["rateUpload"] = true;
+  fields["eta"] = true;
+  fields["status"] = true;
+  listFilter["arguments"]["removed"] = true;
+}
+
+void torrentListLoop() {
+  TransmissionClient &client = speedMonitorClient();
+  if (!enabled || currentState != STATE_CONNECTED) {
+    if (inFlight)
+      client.reset(); // also drops the keep-alive socket
+    if (syncState != SYNC_COUNT)
+      startSync();
+    inFlight = false;
+    return;
+  }
+
+  // The speed monitor polls the client; the reply is read here
+  if (inFlight) {
+    if (!client.finished())
+      return;
+    inFlight = false;
+    bool ok = client.state() == RPC_DONE;
+    bool retry = client.tooLarge();
+    finishRequest();
+    client.release();
+    // Sync pages go back to back, but only after the speed monitor had its
+    // turn on the client: the next one starts on a later pass
+    if ((ok && syncState != SYNC_DELTA && deltaFits) || retry)
+      lastPoll = millis() - TORRENT_POLL_INTERVAL;
+    return;
+  }
+
+  // Nothing while the speed monitor's polls fail: its backoff then keeps
+  // both off an unreachable host
+  if (!client.idle() || !speedMonitorValid())
+    return;
+  // Changes older than the activity window would be missed by a delta
+  if (syncState == SYNC_DELTA && millis() - lastDelta > TORRENT_DELTA_WINDOW)
+    startSync();
+  if (millis() - lastPoll >= TORRENT_POLL_INTERVAL) {
+    lastPoll = millis();
+    startRequest();
+  }
+}
+
+int torrentCount() { return count; }
+
+const TorrentInfo &torrentAt(int i) { return table[i]; }
+
+uint32_t torrentTotal() { return total; }
+
+bool torrentListSynced() { return synced; }
+
+uint32_t torrentListChanges() { return changes; }
+
+uint16_t torrentLastRows() { return lastRows; }
+
+unsigned long torrentSyncCount() { return syncs; }
+
+void torrentListHandle(ESP8266WebServer &server) {
+  server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+  server.send(200, "application/json", "");
+
+  // Rows are batched into one buffer; ArduinoJson escapes the names
+  char buf[512];
+  size_t len = snprintf(buf, sizeof(buf),
+                        "{\"total\":%lu,\"synced\":%s,\"torrents\":[",
+                        (unsigned long)total, synced ? "true" : "false");
+  StaticJsonDocument<192> row;
+  for (int i = 0; i < count; i++) {
+    const TorrentInfo &t = table[i];
+    row.clear();
+    row["id"] = t.id;
+    row["name"] = (const char *)t.name; // stored by pointer, no copy
+    row["done"] = t.permille / 10.0;
+    row["down"] = t.down;
+    row["up"] = t.up;
+    row["eta"] = t.eta;
+    row["status"] = t.status;
+    // Worst case: every name byte escaped, plus the other fields
+    if (len + TORRENT_NAME_LEN * 2 + 160 >= sizeof(buf)) {
+      server.sendContent(buf, len);
+      len = 0;
+    }
+    if (i)
+      buf[len++] = ',';
+    len += serializeJson(row, buf + len, sizeof(buf) - len);
+  }
+  len += snprintf(buf + len, sizeof(buf) - len, "]}");
+  server.sendContent(buf, len);
+  server.sendContent(""); // terminating chunk
+}
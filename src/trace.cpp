@@ -0,0 +1,80 @@
+#include "trace.h"
+
+#if TRACE_ENABLED
+
+struct TraceEvent {
+  uint32_t ts; // micros()
+  uint16_t id;
+  char phase; // 'B'egin, 'E'nd, 'i'nstant
+  uint8_t reserved;
+};
+
+static_assert((TRACE_CAPACITY & (TRACE_CAPACITY - 1)) == 0,
+              "TRACE_CAPACITY must be a power of two");
+
+static TraceEvent events[TRACE_CAPACITY];
+static uint32_t head = 0; // total events ever recorded
+static bool paused = false;
+
+static const char *names[TRACE_MAX_NAMES] = {
+    "loop",        "rpc",       "rpc_connect",  "rpc_sent",
+    "rpc_headers", "rpc_409",   "rpc_parse",    "draw_status_bar",
+    "display_flush",
+};
+static uint16_t nameCount = TRACE_FIXED_NAMES;
+
+uint16_t traceRegister(const char *name) {
+  if (nameCount >= TRACE_MAX_NAMES)
+    return TRACE_LOOP; // out of ids: fold into the loop span's name
+  names[nameCount] = name;
+  return nameCount++;
+}
+
+void traceRecord(uint16_t id, char phase) {
+  if (paused)
+    return;
+  TraceEvent &e = events[head & (TRACE_CAPACITY - 1)];
+  e.ts = micros();
+  e.id = id;
+  e.phase = phase;
+  head++;
+}
+
+void traceHandle(ESP8266WebServer &server) {
+  // Freeze the buffer so the export does not overwrite what it streams
+  paused = true;
+
+  server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+  server.send(200, "application/json", "");
+  server.sendContent("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+
+  uint32_t count = head < TRACE_CAPACITY ? head : TRACE_CAPACITY;
+  uint32_t first = head - count;
+  uint32_t base = count ? events[first & (TRACE_CAPACITY - 1)].ts : 0;
+
+  char buf[512];
+  size_t len = 0;
+  for (uint32_t i = 0; i < count; i++) {
+    const TraceEvent &e = events[(first + i) & (TRACE_CAPACITY - 1)];
+    if (len > sizeof(buf) - 96) {
+      server.sendContent(buf, len);
+      len = 0;
+    }
+    // Timestamps are relative to the oldest event, which also hides the
+    // 32-bit micros() wrap
+    len += snprintf(buf + len, sizeof(buf) - len,
+                    "%s{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%lu,\"pid\":1,"
+                    "\"tid\":1%s}",
+                    i ? "," : "", e.id < nameCount ? names[e.id] : "?",
+                    e.phase, (unsigned long)(e.ts - base),
+                    e.phase == 'i' ? ",\"s\":\"t\"" : "");
+  }
+  if (len)
+    server.sendContent(buf, len);
+  server.sendContent("]}");
+  server.sendContent(""); // terminating chunk
+
+  paused = false;
+}
+
+#endif
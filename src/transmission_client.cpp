@@ -0,0 +1,412 @@
+#include "transmission_client.h"
+
+#include "metrics.h"
+#include "trace.h"
+
+// "user:pass" at its longest, and its Basic header, must always fit
+#define RPC_CREDENTIALS_LEN (SETTINGS_USER_LEN + SETTINGS_PASS_LEN + 2)
+static_assert(sizeof("Authorization: Basic \r\n") +
+                      (RPC_CREDENTIALS_LEN + 2) / 3 * 4 <=
+                  RPC_AUTH_HEADER_LEN,
+              "RPC_AUTH_HEADER_LEN too small for the longest credentials");
+
+// --- Base64 Helper ---
+static const char PROGMEM b64_alphabet[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+size_t base64Encode(const char *input, size_t len, char *out, size_t outSize) {
+  size_t outLen = ((len + 2) / 3) * 4;
+  if (outLen + 1 > outSize)
+    return 0;
+
+  const uint8_t *in = (const uint8_t *)input;
+  char *p = out;
+  while (len >= 3) {
+    *p++ = pgm_read_byte(&b64_alphabet[in[0] >> 2]);
+    *p++ = pgm_read_byte(&b64_alphabet[((in[0] & 0x03) << 4) | (in[1] >> 4)]);
+    *p++ = pgm_read_byte(&b64_alphabet[((in[1] & 0x0f) << 2) | (in[2] >> 6)]);
+    *p++ = pgm_read_byte(&b64_alphabet[in[2] & 0x3f]);
+    in += 3;
+    len -= 3;
+  }
+  if (len) {
+    uint8_t b1 = (len > 1) ? in[1] : 0;
+    *p++ = pgm_read_byte(&b64_alphabet[in[0] >> 2]);
+    *p++ = pgm_read_byte(&b64_alphabet[((in[0] & 0x03) << 4) | (b1 >> 4)]);
+    *p++ = (len > 1) ? pgm_read_byte(&b64_alphabet[(b1 & 0x0f) << 2]) : '=';
+    *p++ = '=';
+  }
+  *p = '\0';
+  return outLen;
+}
+
+// --- Body Stream ---
+// Reads the body of the current response from the socket: bounded by its
+// Content-Length, or unwrapped from chunked framing, so the parser never
+// consumes bytes of the next keep-alive response.
+class BodyStream : public Stream {
+public:
+  BodyStream(WiFiClient &client, long &read, long length,
+             HttpChunkDecoder *chunks)
+      : _client(client), _read(read), _length(length), _chunks(chunks) {}
+
+  // Caps the time spent waiting for bytes over all reads, not per read
+  void setWaitLimit(unsigned long ms) {
+    setTimeout(ms);
+    _waitEnd = millis() + ms;
+  }
+
+  // A broken chunk framing also ends the body; the caller checks failed()
+  bool complete() const {
+    if (_chunks)
+      return _chunks->done() || _chunks->failed();
+    return _length >= 0 && _read >= _length;
+  }
+
+  int available() override {
+    if (complete())
+      return 0;
+    int n = _client.available();
+    if (!_chunks && _length >= 0 && n > _length - _read)
+      n = _length - _read;
+    return n;
+  }
+  int read() override {
+    while (!complete()) {
+      int c = _client.read();
+      if (c < 0) {
+        if (_timeout && (long)(millis() - _waitEnd) >= 0)
+          _timeout = 0; // ends the wait in Stream::timedRead()
+        return -1;
+      }
+      _read++;
+      if (!_chunks || _chunks->feed(c))
+        return c;
+    }
+    return -1;
+  }
+  int peek() override {
+    if (complete() || (_chunks && !_chunks->inData()))
+      return -1;
+    return _client.peek();
+  }
+  size_t write(uint8_t) override { return 0; }
+
+private:
+  WiFiClient &_client;
+  long &_read;
+  long _length;
+  HttpChunkDecoder *_chunks;
+  unsigned long _waitEnd = 0;
+};
+
+// --- Public API ---
+
+void TransmissionClient::configure(const TransmissionSettings &target) {
+  // A different server invalidates both the socket and the session id
+  if (strcmp(target.host, _target.host) != 0 ||
+      target.port != _target.port) {
+    _client.stop();
+    _sessionId[0] = '\0';
+  }
+
+  // The credential header only changes with the settings
+  if (strcmp(target.user, _target.user) != 0 ||
+      strcmp(target.pass, _target.pass) != 0) {
+    _authHeader[0] = '\0';
+    if (target.user[0] || target.pass[0]) {
+      char credentials[RPC_CREDENTIALS_LEN];
+      size_t len = snprintf(credentials, sizeof(credentials), "%s:%s",
+                            target.user, target.pass);
+      int prefix = snprintf(_authHeader, sizeof(_authHeader),
+                            "Authorization: Basic ");
+      size_t encoded =
+          (len < sizeof(credentials))
+              ? base64Encode(credentials, len, _authHeader + prefix,
+                             sizeof(_authHeader) - prefix - 2)
+              : 0;
+      if (encoded) {
+        strcpy(_authHeader + prefix + encoded, "\r\n");
+      } else {
+        Serial.println("RPC credentials too long");
+        _authHeader[0] = '\0';
+      }
+    }
+  }
+
+  _target = target;
+}
+
+bool TransmissionClient::start(const char *payload, JsonDocument &result,
+                               const JsonDocument *filter) {
+  if (busy())
+    return false;
+
+  _payload = payload;
+  _result = &result;
+  _filter = filter;
+  _result->clear();
+  _error = "";
+  _tooLarge = false;
+  _heapStart = ESP.getFreeHeap();
+  _heapMin = _heapStart;
+  _startedAt = millis();
+  _attempt = 0;
+  _state = RPC_CONNECTING;
+  _requests++;
+  TRACE_BEGIN(TRACE_RPC);
+  return true;
+}
+
+void TransmissionClient::reset() {
+  if (busy())
+    TRACE_END(TRACE_RPC);
+  _client.stop();
+  _state = RPC_IDLE;
+}
+
+void TransmissionClient::poll() {
+  if (busy()) {
+    uint32_t heap = ESP.getFreeHeap();
+    if (heap < _heapMin)
+      _heapMin = heap;
+  }
+
+  switch (_state) {
+  case RPC_CONNECTING:
+    // Reuse the keep-alive socket if the server has not closed it
+    if (_client.connected()) {
+      _reused = true;
+      _state = RPC_SENDING;
+      break;
+    }
+
+    // Note: WiFiClient::connect() itself blocks until the TCP handshake
+    // completes, bounded by RPC_CONNECT_TIMEOUT. After it, each pass only
+    // handles bytes that are already buffered; the body is not parsed
+    // until it is all in (see bodyBuffered()).
+    _reused = false;
+    _reconnects++;
+    _client.setTimeout(RPC_CONNECT_TIMEOUT);
+    TRACE_BEGIN(TRACE_RPC_CONNECT);
+    if (!_client.connect(_target.host, _target.port)) {
+      TRACE_END(TRACE_RPC_CONNECT);
+      fail(_attempt == 0 ? "Conn Failed (TCP)" : "Conn Failed (Reconnect)");
+      return;
+    }
+    TRACE_END(TRACE_RPC_CONNECT);
+    _client.setNoDelay(true);
+    _state = RPC_SENDING;
+    break;
+
+  case RPC_SENDING:
+    sendRequest();
+    if (_state == RPC_FAILED)
+      return;
+    _response.reset();
+    _headerRead = 0;
+    _stateStart = millis();
+    _state = RPC_READING_HEADERS;
+    TRACE_INSTANT(TRACE_RPC_SENT);
+    break;
+
+  case RPC_READING_HEADERS:
+    // Parse straight out of the socket's receive buffer
+    while (_client.peekAvailable()) {
+      size_t used =
+          _response.feed(_client.peekBuffer(), _client.peekAvailable());
+      _client.peekConsume(used);
+      _headerRead += used;
+
+      if (_response.failed()) {
+        fail("Bad HTTP Response");
+        return;
+      }
+      if (_response.done()) {
+        TRACE_INSTANT(TRACE_RPC_HEADERS);
+        processHeaders();
+        return;
+      }
+    }
+
+    if (!_client.connected() && _headerRead == 0) {
+      // A reused socket closed by the server before answering
+      _client.stop();
+      if (_reused) {
+        _state = RPC_CONNECTING;
+        return;
+      }
+      fail(_attempt == 0 ? "Conn Failed (TCP)" : "Conn Failed (Reconnect)");
+    } else if (millis() - _stateStart > RPC_RESPONSE_TIMEOUT) {
+      fail(_attempt == 0 ? "Timeout (1)" : "Timeout (2)");
+    }
+    break;
+
+  case RPC_READING_BODY: {
+    if (_response.status() == 200 && !_parsed && _client.available()) {
+      if (!bodyBuffered()) {
+        if (millis() - _stateStart > RPC_RESPONSE_TIMEOUT)
+          fail(_attempt == 0 ? "Timeout (1)" : "Timeout (2)");
+        break;
+      }
+      parseBody();
+      if (_state != RPC_READING_BODY)
+        return;
+    }
+
+    // Discard whatever is left (409 error page, trailing whitespace)
+    BodyStream body(_client, _bodyRead, _response.contentLength(),
+                    _response.chunked() ? &_chunks : nullptr);
+    while (!body.complete() && _client.available())
+      body.read();
+
+    if (_response.chunked() && _chunks.failed()) {
+      fail("Bad HTTP Response");
+    } else if (body.complete() || !_client.connected()) {
+      finishResponse();
+    } else if (millis() - _stateStart > RPC_RESPONSE_TIMEOUT) {
+      fail(_attempt == 0 ? "Timeout (1)" : "Timeout (2)");
+    }
+    break;
+  }
+
+  default:
+    break;
+  }
+}
+
+// --- Internals ---
+
+void TransmissionClient::sendRequest() {
+  size_t payloadLen = strlen(_payload);
+  int len = snprintf(_request, sizeof(_request),
+                     "POST %s HTTP/1.1\r\n"
+                     "Host: %s\r\n"
+                     "%s"
+                     "%s%s%s"
+                     "Content-Type: application/json\r\n"
+                     "Content-Length: %u\r\n"
+                     "Connection: keep-alive\r\n\r\n",
+                     _target.path, _target.host, _authHeader,
+                     _sessionId[0] ? "X-Transmission-Session-Id: " : "",
+                     _sessionId, _sessionId[0] ? "\r\n" : "",
+                     (unsigned)payloadLen);
+  if (len < 0 || (size_t)len >= sizeof(_request)) {
+    fail("Request Too Large");
+    return;
+  }
+
+  // One write for the whole request when the payload fits behind the headers
+  if (len + payloadLen < sizeof(_request)) {
+    memcpy(_request + len, _payload, payloadLen);
+    _client.write((const uint8_t *)_request, len + payloadLen);
+  } else {
+    _client.write((const uint8_t *)_request, len);
+    _client.write((const uint8_t *)_payload, payloadLen);
+  }
+}
+
+void TransmissionClient::processHeaders() {
+  int status = _response.status();
+  const char *sessionId = _response.sessionId();
+
+  if (status == 401) {
+    fail("Auth Failed (401)");
+    return;
+  }
+  if (status == 409) {
+    // Stale or missing session id: drain the error body, then resend
+    if (!sessionId[0] || _attempt > 0) {
+      _sessionId[0] = '\0';
+      fail("No Session ID (Path?)");
+      return;
+    }
+    strlcpy(_sessionId, sessionId, sizeof(_sessionId));
+    _handshakes++;
+    _attempt++;
+  } else if (status != 200) {
+    char message[24];
+    snprintf(message, sizeof(message), "HTTP Error %d", status);
+    fail(message);
+    return;
+  }
+
+  _chunks.reset();
+  _bodyRead = 0;
+  _bodyBuffered = 0;
+  _parsed = false;
+  _stateStart = millis();
+  _state = RPC_READING_BODY;
+}
+
+// True once the body can be parsed without waiting on the network: all of
+// it is buffered, or as much as the receive window holds, or the server has
+// stopped sending.
+bool TransmissionClient::bodyBuffered() {
+  long buffered = _client.available();
+  if (buffered != _bodyBuffered) {
+    _bodyBuffered = buffered;
+    _bodyGrewAt = millis();
+  }
+  if (buffered >= RPC_RX_WINDOW || !_client.connected())
+    return true;
+  if (!_response.chunked() && _response.contentLength() >= 0)
+    return buffered >= _response.contentLength();
+  // Chunked, or delimited by the server closing: the end cannot be seen
+  // without reading, so a pause after a burst is taken as the end
+  return millis() - _bodyGrewAt >= RPC_BODY_SETTLE_MS;
+}
+
+void TransmissionClient::parseBody() {
+  TRACE_SCOPE(TRACE_RPC_PARSE);
+
+  // The body is buffered, or fills the receive window and the rest follows
+  // as the parser drains it. A body that stalls fails the request after
+  // RPC_PARSE_WAIT_MS in all instead of stalling loop().
+  BodyStream body(_client, _bodyRead, _response.contentLength(),
+                  _response.chunked() ? &_chunks : nullptr);
+  body.setWaitLimit(RPC_PARSE_WAIT_MS);
+
+  DeserializationError error =
+      _filter ? deserializeJson(*_result, body,
+                                DeserializationOption::Filter(*_filter))
+              : deserializeJson(*_result, body);
+  _parsed = true;
+
+  uint32_t heap = ESP.getFreeHeap();
+  if (heap < _heapMin)
+    _heapMin = heap;
+
+  if (error) {
+    Serial.printf("RPC parse error: %s\n", error.c_str());
+    _tooLarge = error == DeserializationError::NoMemory;
+    fail(_tooLarge ? "Reply Too Large" : "JSON Parse Err");
+  }
+}
+
+void TransmissionClient::finishResponse() {
+  // Without length or chunking the body was delimited by the server closing
+  if (!_response.keepAlive() ||
+      (_response.contentLength() < 0 && !_response.chunked()))
+    _client.stop();
+
+  if (_response.status() == 409) {
+    TRACE_INSTANT(TRACE_RPC_HANDSHAKE);
+    _state = RPC_CONNECTING; // retry with the fresh session id
+    return;
+  }
+  if (!_parsed) {
+    fail("Invalid Resp Body");
+    return;
+  }
+  _roundTrip = millis() - _startedAt;
+  metricsObserveRpc(_roundTrip);
+  _state = RPC_DONE;
+  TRACE_END(TRACE_RPC);
+}
+
+void TransmissionClient::fail(const char *message) {
+  _client.stop();
+  _error = message;
+  _state = RPC_FAILED;
+  TRACE_END(TRACE_RPC);
+}
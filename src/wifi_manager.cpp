@@ -0,0 +1,287 @@
+#include "wifi_manager.h"
+
+#include <ESP8266WiFi.h>
+#include <coredecls.h>
+
+#include "wifi_scan.h"
+
+struct FastConnectCache {
+  uint32_t crc; // over everything below
+  uint32_t ssidCrc;
+  uint32_t ip;
+  uint32_t gateway;
+  uint32_t subnet;
+  uint32_t dns;
+  uint8_t bssid[6];
+  uint8_t channel;
+  uint8_t reserved;
+};
+
+// Current round: saved network indexes in the order they are tried
+static uint8_t order[SETTINGS_MAX_NETWORKS];
+static int orderPos = 0;
+static bool fastAttempt = false;
+static unsigned long attemptStart = 0;
+static unsigned long roundWaitStart = 0;
+static unsigned long backoff = 0; // 0 = not waiting
+static unsigned long roundBackoff = 0; // doubles with every failed round
+static unsigned long bootAttemptStart = 0;
+
+static unsigned long disconnectedAt = 0;
+static unsigned long lastRoamScan = 0;
+static unsigned long lastScanSeen = 0;
+
+static bool fastUsed = false;
+static unsigned long firstConnect = 0;
+static unsigned long lastReconnect = 0;
+static uint32_t reconnects = 0;
+static uint32_t failovers = 0;
+static uint32_t roams = 0;
+
+// --- Fast Connect Cache ---
+
+static uint32_t cacheCrc(const FastConnectCache &c) {
+  return crc32((const uint8_t *)&c + sizeof(c.crc), sizeof(c) - sizeof(c.crc));
+}
+
+static uint32_t ssidCrc(const char *ssid) {
+  return crc32(ssid, strlen(ssid));
+}
+
+static bool loadCache(FastConnectCache &c) {
+  if (!ESP.rtcUserMemoryRead(WIFI_RTC_OFFSET, (uint32_t *)&c, sizeof(c)))
+    return false;
+  return c.crc == cacheCrc(c) && c.channel >= 1 && c.channel <= 14;
+}
+
+static void saveCache() {
+  FastConnectCache c;
+  memset(&c, 0, sizeof(c));
+  c.ssidCrc = ssidCrc(WiFi.SSID().c_str());
+  c.ip = (uint32_t)WiFi.localIP();
+  c.gateway = (uint32_t)WiFi.gatewayIP();
+  c.subnet = (uint32_t)WiFi.subnetMask();
+  c.dns = (uint32_t)WiFi.dnsIP();
+  memcpy(c.bssid, WiFi.BSSID(), sizeof(c.bssid));
+  c.channel = (uint8_t)WiFi.channel();
+  c.crc = cacheCrc(c);
+  ESP.rtcUserMemoryWrite(WIFI_RTC_OFFSET, (uint32_t *)&c, sizeof(c));
+}
+
+static void invalidateCache() {
+  FastConnectCache c;
+  memset(&c, 0, sizeof(c));
+  ESP.rtcUserMemoryWrite(WIFI_RTC_OFFSET, (uint32_t *)&c, sizeof(c));
+}
+
+// --- Connecting ---
+
+// Last-seen RSSI of a saved network in the scan cache, -128 if never seen
+static int lastSeenRssi(const char *ssid) {
+  for (int i = 0; i < wifiScanCount(); i++) {
+    if (strcmp(ssid, wifiScanResult(i).ssid) == 0)
+      return wifiScanResult(i).rssi;
+  }
+  return -128;
+}
+
+static void rankNetworks() {
+  int rssi[SETTINGS_MAX_NETWORKS];
+  FastConnectCache c;
+  bool cached = loadCache(c);
+  for (int i = 0; i < settings.networkCount; i++) {
+    rssi[i] = lastSeenRssi(settings.networks[i].ssid);
+    // Before the first scan, the network from the fast connect cache leads
+    if (rssi[i] == -128 && cached &&
+        c.ssidCrc == ssidCrc(settings.networks[i].ssid))
+      rssi[i] = -127;
+  }
+
+  // Stable insertion sort: equal RSSI keeps the saved priority
+  for (int i = 0; i < settings.networkCount; i++) {
+    int j = i;
+    while (j > 0 && rssi[order[j - 1]] < rssi[i]) {
+      order[j] = order[j - 1];
+      j--;
+    }
+    order[j] = i;
+  }
+}
+
+static void beginFull(const WifiNetwork &net) {
+  WiFi.config(IPAddress(), IPAddress(), IPAddress()); // back to DHCP
+  WiFi.begin(net.ssid, net.pass);
+}
+
+static void tryCandidate() {
+  const WifiNetwork &net = settings.networks[order[orderPos]];
+  attemptStart = millis();
+
+  FastConnectCache c;
+  fastAttempt = loadCache(c) && c.ssidCrc == ssidCrc(net.ssid);
+  if (!fastAttempt) {
+    Serial.printf("Connecting to %s\n", net.ssid);
+    beginFull(net);
+    return;
+  }
+
+  Serial.printf("Fast connect to %s: channel %u, cached IP\n",
+                net.ssid, c.channel);
+  if (c.ip)
+    WiFi.config(IPAddress(c.ip), IPAddress(c.gateway), IPAddress(c.subnet),
+                IPAddress(c.dns));
+  WiFi.begin(net.ssid, net.pass, c.channel, c.bssid, true);
+}
+
+static void startRound() {
+  backoff = 0;
+  orderPos = 0;
+  rankNetworks();
+  tryCandidate();
+}
+
+void wifiBegin() {
+  WiFi.persistent(false); // failover must not rewrite the SDK flash config
+  bootAttemptStart = millis();
+  fastUsed = false;
+  if (settings.networkCount)
+    startRound();
+}
+
+bool wifiConnectLoop() {
+  if (!settings.networkCount)
+    return true;
+
+  if (backoff) {
+    // Only the first connection after boot may fall back to AP mode; later
+    // outages keep retrying so a router reboot does not strand the device
+    if (!firstConnect &&
+        millis() - bootAttemptStart > WIFI_AP_FALLBACK_TIMEOUT)
+      return true;
+    if (millis() - roundWaitStart >= backoff)
+      startRound();
+    return false;
+  }
+
+  unsigned long timeout =
+      fastAttempt ? WIFI_FAST_CONNECT_TIMEOUT : WIFI_ATTEMPT_TIMEOUT;
+  if (millis() - attemptStart < timeout)
+    return false;
+
+  if (fastAttempt) {
+    // AP moved, changed channel or the lease is gone: forget it and scan
+    Serial.println("Fast connect failed, falling back to full connect");
+    invalidateCache();
+    WiFi.disconnect();
+    fastAttempt = false;
+    attemptStart = millis();
+    beginFull(settings.networks[order[orderPos]]);
+    return false;
+  }
+
+  WiFi.disconnect();
+  if (++orderPos < settings.networkCount) {
+    failovers++;
+    Serial.printf("Failing over to network %d\n", orderPos + 1);
+    tryCandidate();
+    return false;
+  }
+
+  // Whole round failed: wait, and rescan meanwhile so the next round is
+  // ranked by fresh RSSI
+  roundBackoff = roundBackoff ? roundBackoff * 2 : WIFI_BACKOFF_MIN;
+  if (roundBackoff > WIFI_BACKOFF_MAX)
+    roundBackoff = WIFI_BACKOFF_MAX;
+  backoff = roundBackoff;
+  roundWaitStart = millis();
+  wifiScanRequest();
+  Serial.printf("No network reachable, retrying in %lu ms\n", backoff);
+  return false;
+}
+
+void wifiOnConnected() {
+  bool fast = fastAttempt;
+  saveCache();
+  fastAttempt = false;
+  backoff = 0;
+  roundBackoff = 0;
+  lastRoamScan = millis();
+
+  if (disconnectedAt) {
+    lastReconnect = millis() - disconnectedAt;
+    disconnectedAt = 0;
+    reconnects++;
+    Serial.printf("Reconnected in %lu ms\n", lastReconnect);
+  }
+  if (firstConnect)
+    return;
+
+  firstConnect = millis();
+  fastUsed = fast;
+  Serial.printf("Connected %lu ms after boot (%s connect)\n", firstConnect,
+                fastUsed ? "fast" : "full");
+}
+
+void wifiOnDisconnected() {
+  disconnectedAt = millis();
+  // The SDK retries the same AP first; failover starts after its timeout
+  fastAttempt = false;
+  backoff = 0;
+  attemptStart = millis();
+  rankNetworks();
+  orderPos = 0;
+  for (int i = 0; i < settings.networkCount; i++) {
+    if (WiFi.SSID() == settings.networks[order[i]].ssid) {
+      orderPos = i;
+      break;
+    }
+  }
+}
+
+// --- Roaming ---
+
+void wifiRoamLoop() {
+  if (millis() - lastRoamScan >= WIFI_ROAM_INTERVAL) {
+    lastRoamScan = millis();
+    wifiScanRequest();
+  }
+
+  unsigned long scanTime = wifiScanTime();
+  if (scanTime == lastScanSeen)
+    return;
+  lastScanSeen = scanTime;
+
+  // Strongest saved AP in the new results (sorted strongest first)
+  for (int i = 0; i < wifiScanCount(); i++) {
+    const ScanResult &r = wifiScanResult(i);
+    for (int n = 0; n < settings.networkCount; n++) {
+      if (strcmp(settings.networks[n].ssid, r.ssid) != 0)
+        continue;
+      if (r.rssi < WiFi.RSSI() + WIFI_ROAM_HYSTERESIS ||
+          memcmp(r.bssid, WiFi.BSSID(), sizeof(r.bssid)) == 0)
+        return;
+
+      Serial.printf("Roaming to %s (%d dBm, channel %u)\n", r.ssid, r.rssi,
+                    r.channel);
+      roams++;
+      WiFi.config(IPAddress(), IPAddress(), IPAddress());
+      WiFi.begin(settings.networks[n].ssid, settings.networks[n].pass,
+                 r.channel, r.bssid, true);
+      return;
+    }
+  }
+}
+
+// --- Metrics ---
+
+bool wifiFastConnectUsed() { return fastUsed; }
+
+unsigned long wifiConnectTime() { return firstConnect; }
+
+unsigned long wifiLastReconnectTime() { return lastReconnect; }
+
+uint32_t wifiReconnectCount() { return reconnects; }
+
+uint32_t wifiFailoverCount() { return failovers; }
+
+uint32_t wifiRoamCount() { return roams; }
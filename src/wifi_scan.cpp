@@ -0,0 +1,138 @@
+#include "wifi_scan.h"
+
+#include <ESP8266WiFi.h>
+
+#define SCAN_JSON_BUFFER 512
+
+static ScanResult results[SCAN_MAX_RESULTS];
+static int resultCount = 0;
+static unsigned long scannedAt = 0;
+static bool haveResults = false;
+static bool scanning = false;
+
+void wifiScanRequest() {
+  if (scanning)
+    return; // merged into the scan already on air
+  if (haveResults && millis() - scannedAt < SCAN_TTL)
+    return;
+  WiFi.scanNetworks(true);
+  scanning = true;
+}
+
+// Keeps the strongest entry per SSID, sorted by RSSI (strongest first)
+static void addResult(int index) {
+  String ssid = WiFi.SSID(index);
+  int32_t rssi = WiFi.RSSI(index);
+  if (ssid.length() == 0)
+    return; // hidden network
+  for (int i = 0; i < resultCount; i++) {
+    if (ssid == results[i].ssid) {
+      if (rssi <= results[i].rssi)
+        return;
+      // Remove the weaker copy and re-insert below
+      memmove(&results[i], &results[i + 1],
+              (resultCount - i - 1) * sizeof(ScanResult));
+      resultCount--;
+      break;
+    }
+  }
+
+  int pos = resultCount;
+  while (pos > 0 && results[pos - 1].rssi < rssi)
+    pos--;
+  if (pos >= SCAN_MAX_RESULTS)
+    return;
+  int moved = min(resultCount, SCAN_MAX_RESULTS - 1) - pos;
+  if (moved > 0)
+    memmove(&results[pos + 1], &results[pos], moved * sizeof(ScanResult));
+  strlcpy(results[pos].ssid, ssid.c_str(), sizeof(results[pos].ssid));
+  results[pos].rssi = (int8_t)rssi;
+  memcpy(results[pos].bssid, WiFi.BSSID(index), sizeof(results[pos].bssid));
+  results[pos].channel = (uint8_t)WiFi.channel(index);
+  if (resultCount < SCAN_MAX_RESULTS)
+    resultCount++;
+}
+
+void wifiScanLoop() {
+  if (!scanning)
+    return;
+  int n = WiFi.scanComplete();
+  if (n == WIFI_SCAN_RUNNING)
+    return;
+
+  scanning = false;
+  if (n < 0)
+    return; // failed; keep the old cache and retry on the next request
+
+  resultCount = 0;
+  for (int i = 0; i < n; i++) {
+    addResult(i);
+  }
+  WiFi.scanDelete(); // free the SDK's copy
+  scannedAt = millis();
+  haveResults = true;
+}
+
+// Appends s as a JSON string body (without quotes); returns the new length
+static size_t jsonEscape(const char *s, char *out, size_t n, size_t size) {
+  for (; *s; s++) {
+    unsigned char c = (unsigned char)*s;
+    char rep[7];
+    size_t repLen;
+    if (c == '"' || c == '\\') {
+      rep[0] = '\\';
+      rep[1] = (char)c;
+      repLen = 2;
+    } else if (c < 0x20) {
+      repLen = snprintf(rep, sizeof(rep), "\\u%04x", c);
+    } else {
+      rep[0] = (char)c;
+      repLen = 1;
+    }
+    if (n + repLen >= size)
+      break;
+    memcpy(out + n, rep, repLen);
+    n += repLen;
+  }
+  return n;
+}
+
+void wifiScanHandle(ESP8266WebServer &server) {
+  wifiScanRequest();
+  if (!haveResults) {
+    // First scan still on air; the page retries
+    server.send(202, "application/json", "[]");
+    return;
+  }
+
+  server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+  server.send(200, "application/json", "");
+
+  // Entries are batched into one buffer so each chunk carries several
+  char buf[SCAN_JSON_BUFFER];
+  size_t len = 0;
+  buf[len++] = '[';
+  for (int i = 0; i < resultCount; i++) {
+    // Worst case: 32 escaped bytes (6 each) plus the fixed text
+    if (len + 32 * 6 + 32 >= sizeof(buf)) {
+      server.sendContent(buf, len);
+      len = 0;
+    }
+    len += snprintf(buf + len, sizeof(buf) - len, "%s{\"ssid\":\"",
+                    i ? "," : "");
+    len = jsonEscape(results[i].ssid, buf, len, sizeof(buf));
+    len += snprintf(buf + len, sizeof(buf) - len, "\",\"rssi\":%d}",
+                    results[i].rssi);
+  }
+  buf[len++] = ']';
+  server.sendContent(buf, len);
+  server.sendContent(""); // terminating chunk
+}
+
+bool wifiScanRunning() { return scanning; }
+
+unsigned long wifiScanTime() { return haveResults ? scannedAt : 0; }
+
+int wifiScanCount() { return resultCount; }
+
+const ScanResult &wifiScanResult(int i) { return results[i]; }
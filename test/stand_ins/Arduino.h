@@ -0,0 +1,278 @@
+#ifndef STAND_IN_ARDUINO_H
+#define STAND_IN_ARDUINO_H
+
+// Host stand-in for the parts of the ESP8266 Arduino core the firmware
+// uses. Time is the host clock plus a skew tests can advance, and delay()
+// only advances the skew, so timeouts run instantly. String data lives on a
+// model of the ESP's heap, which ESP.getFreeHeap() and friends report on.
+
+#include <math.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <functional>
+#include <new>
+#include <string>
+
+// --- PROGMEM (flat memory on the host) ---
+#define PROGMEM
+#define PGM_P const char *
+#define PSTR(s) (s)
+#define F(s) ((const __FlashStringHelper *)(s))
+#define FPSTR(s) ((const __FlashStringHelper *)(s))
+#define pgm_read_byte(a) (*(const uint8_t *)(a))
+#define pgm_read_word(a) (*(const uint16_t *)(a))
+#define pgm_read_dword(a) (*(const uint32_t *)(a))
+#define strlen_P strlen
+#define memcpy_P memcpy
+#define strncpy_P strncpy
+#define strcmp_P strcmp
+#define strncmp_P strncmp
+#define snprintf_P snprintf
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0
+#define OUTPUT 1
+#define LED_BUILTIN 2
+
+class __FlashStringHelper;
+
+#if !defined(__GLIBC__) || !__GLIBC_PREREQ(2, 38)
+size_t strlcpy(char *dst, const char *src, size_t size);
+#endif
+
+// --- Time ---
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void yield();
+void standInAdvance(unsigned long ms); // moves millis()/micros() forward
+
+void pinMode(int pin, int mode);
+void digitalWrite(int pin, int value);
+
+template <class T> T min(T a, T b) { return a < b ? a : b; }
+template <class T> T max(T a, T b) { return a > b ? a : b; }
+template <class T, class U, class V> T constrain(T a, U low, V high) {
+  return a < (T)low ? (T)low : (a > (T)high ? (T)high : a);
+}
+
+// --- Heap ---
+// A STAND_IN_HEAP_BYTES arena managed the way umm_malloc manages the ESP's
+// heap, so fragmentation from String churn shows up in
+// ESP.getHeapFragmentation() as it would on the device.
+#define STAND_IN_HEAP_BYTES 40000
+
+void *standInMalloc(size_t size); // null when no free run is large enough
+void standInFree(void *p);
+unsigned long standInHeapAllocs(); // since start-up
+
+template <class T> struct StandInHeapAllocator {
+  typedef T value_type;
+  StandInHeapAllocator() {}
+  template <class U> StandInHeapAllocator(const StandInHeapAllocator<U> &) {}
+  T *allocate(size_t n) {
+    if (void *p = standInMalloc(n * sizeof(T)))
+      return (T *)p;
+    throw std::bad_alloc();
+  }
+  void deallocate(T *p, size_t) { standInFree(p); }
+  template <class U> bool operator==(const StandInHeapAllocator<U> &) const {
+    return true;
+  }
+  template <class U> bool operator!=(const StandInHeapAllocator<U> &) const {
+    return false;
+  }
+};
+
+typedef std::basic_string<char, std::char_traits<char>,
+                          StandInHeapAllocator<char>>
+    StandInHeapString;
+
+// --- String ---
+class String {
+public:
+  String(const char *s = "") : _s(s ? s : "") {}
+  String(const __FlashStringHelper *s) : _s((const char *)s) {}
+  String(const std::string &s) : _s(s.data(), s.size()) {}
+  String(const StandInHeapString &s) : _s(s) {}
+  String(char c) : _s(1, c) {}
+  String(int v) : _s(std::to_string(v).c_str()) {}
+  String(unsigned v) : _s(std::to_string(v).c_str()) {}
+  String(long v) : _s(std::to_string(v).c_str()) {}
+  String(unsigned long v) : _s(std::to_string(v).c_str()) {}
+  String(float v, int decimals = 2);
+  String(double v, int decimals = 2);
+
+  unsigned length() const { return _s.size(); }
+  const char *c_str() const { return _s.c_str(); }
+  bool isEmpty() const { return _s.empty(); }
+  bool reserve(unsigned size) {
+    _s.reserve(size);
+    return true;
+  }
+  bool concat(const char *s) {
+    _s += s ? s : "";
+    return true;
+  }
+  bool concat(const char *s, unsigned n) {
+    _s.append(s, n);
+    return true;
+  }
+  bool concat(char c) {
+    _s += c;
+    return true;
+  }
+
+  String &operator+=(const String &o) {
+    _s += o._s;
+    return *this;
+  }
+  String &operator+=(const char *o) {
+    concat(o);
+    return *this;
+  }
+  String &operator+=(char c) {
+    _s += c;
+    return *this;
+  }
+  friend String operator+(const String &a, const String &b) {
+    return String(a._s + b._s);
+  }
+  bool operator==(const String &o) const { return _s == o._s; }
+  bool operator==(const char *o) const { return _s == (o ? o : ""); }
+  bool operator!=(const String &o) const { return _s != o._s; }
+  bool operator!=(const char *o) const { return !(*this == o); }
+  char operator[](unsigned i) const { return i < _s.size() ? _s[i] : 0; }
+
+  int indexOf(const char *s) const;
+  int indexOf(char c) const;
+  String substring(unsigned from, unsigned to = ~0u) const;
+  long toInt() const { return atol(_s.c_str()); }
+  void trim();
+  bool startsWith(const char *s) const { return _s.rfind(s, 0) == 0; }
+  void replace(const char *from, const String &to);
+
+private:
+  StandInHeapString _s;
+};
+
+// ArduinoJson's String adapter also names the type of a + b
+class StringSumHelper : public String {};
+
+// --- Print / Stream ---
+class Print {
+public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t c) = 0;
+  virtual size_t write(const uint8_t *buf, size_t n);
+  size_t write(const char *s) { return write((const uint8_t *)s, strlen(s)); }
+  size_t write(const char *s, size_t n) { return write((const uint8_t *)s, n); }
+
+  size_t print(const String &s) { return write(s.c_str(), s.length()); }
+  size_t print(const char *s) { return write(s); }
+  size_t print(const __FlashStringHelper *s) { return write((const char *)s); }
+  size_t print(char c) { return write((uint8_t)c); }
+  size_t print(int v) { return printf("%d", v); }
+  size_t print(unsigned v) { return printf("%u", v); }
+  size_t print(long v) { return printf("%ld", v); }
+  size_t print(unsigned long v) { return printf("%lu", v); }
+  template <class T> size_t println(const T &v) { return print(v) + println(); }
+  size_t println() { return write("\r\n"); }
+  size_t printf(const char *format, ...)
+      __attribute__((format(printf, 2, 3)));
+  size_t printf_P(const char *format, ...);
+  virtual void flush() {}
+};
+
+class Stream : public Print {
+public:
+  virtual int available() = 0;
+  virtual int read() = 0;
+  virtual int peek() = 0;
+  void setTimeout(unsigned long ms) { _timeout = ms; }
+  size_t readBytes(char *buf, size_t n);
+  size_t readBytes(uint8_t *buf, size_t n) { return readBytes((char *)buf, n); }
+  String readStringUntil(char terminator);
+  String readString();
+
+protected:
+  unsigned long _timeout = 1000;
+  int timedRead(); // like the core: polls read() until _timeout runs out
+};
+
+// Serial output is dropped unless the test asks to see it
+class HardwareSerial : public Stream {
+public:
+  void begin(long) {}
+  void setDebugOutput(bool) {}
+  size_t write(uint8_t c) override;
+  using Print::write;
+  int available() override { return 0; }
+  int read() override { return -1; }
+  int peek() override { return -1; }
+  bool echo = false;
+};
+extern HardwareSerial Serial;
+
+// --- IPAddress ---
+class IPAddress {
+public:
+  IPAddress() : _v(0) {}
+  IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d)
+      : _v(a | b << 8 | c << 16 | (uint32_t)d << 24) {}
+  IPAddress(uint32_t v) : _v(v) {}
+  operator uint32_t() const { return _v; }
+  uint8_t operator[](int i) const { return _v >> (8 * i); }
+  bool operator==(const IPAddress &o) const { return _v == o._v; }
+  bool operator!=(const IPAddress &o) const { return _v != o._v; }
+  bool isSet() const { return _v != 0; }
+  String toString() const;
+
+private:
+  uint32_t _v;
+};
+
+// --- ESP ---
+struct rst_info {
+  uint32_t reason, exccause, epc1, epc2, epc3, excvaddr, depc;
+};
+enum {
+  REASON_DEFAULT_RST,
+  REASON_WDT_RST,
+  REASON_EXCEPTION_RST,
+  REASON_SOFT_WDT_RST,
+  REASON_SOFT_RESTART,
+  REASON_DEEP_SLEEP_AWAKE,
+  REASON_EXT_SYS_RST
+};
+
+#define STAND_IN_RTC_BYTES 512
+
+class EspClass {
+public:
+  void restart() { restarts++; }
+  uint32_t getFreeHeap();
+  uint32_t getMaxFreeBlockSize();
+  uint8_t getHeapFragmentation();
+  uint32_t getCycleCount(); // host nanoseconds at getCpuFreqMHz()
+  uint8_t getCpuFreqMHz() { return 80; }
+  uint32_t getFreeSketchSpace() { return 1 << 20; }
+  uint32_t getChipId() { return 0x00C0FFEE; }
+  bool rtcUserMemoryRead(uint32_t offset, uint32_t *data, size_t size);
+  bool rtcUserMemoryWrite(uint32_t offset, uint32_t *data, size_t size);
+  rst_info *getResetInfoPtr() { return &resetInfo; }
+  String getResetReason() { return "Power On"; }
+
+  rst_info resetInfo = {};
+  uint8_t rtc[STAND_IN_RTC_BYTES] = {};
+  unsigned restarts = 0;
+};
+extern EspClass ESP;
+
+#endif
@@ -0,0 +1,126 @@
+#ifndef STAND_IN_ESP8266WEBSERVER_H
+#define STAND_IN_ESP8266WEBSERVER_H
+
+#include <ESP8266WiFi.h>
+
+#include <map>
+#include <vector>
+
+enum HTTPMethod { HTTP_ANY, HTTP_GET, HTTP_POST, HTTP_PUT, HTTP_DELETE };
+enum HTTPUploadStatus {
+  UPLOAD_FILE_START,
+  UPLOAD_FILE_WRITE,
+  UPLOAD_FILE_END,
+  UPLOAD_FILE_ABORTED
+};
+
+#define CONTENT_LENGTH_UNKNOWN ((size_t)-1)
+#define CONTENT_LENGTH_NOT_SET ((size_t)-2)
+#define HTTP_UPLOAD_BUFLEN 2048
+
+struct HTTPUpload {
+  HTTPUploadStatus status;
+  String filename;
+  String name;
+  String type;
+  size_t totalSize;
+  size_t currentSize;
+  uint8_t buf[HTTP_UPLOAD_BUFLEN];
+};
+
+// Records what a handler sends instead of writing it to a socket. Tests set
+// the request up with the public fields and run a route with request().
+class ESP8266WebServer {
+public:
+  typedef std::function<void()> THandlerFunction;
+
+  explicit ESP8266WebServer(int port = 80) : _port(port) {}
+
+  void begin() {}
+  void handleClient() {}
+  void on(const char *uri, THandlerFunction handler) {
+    on(uri, HTTP_ANY, handler);
+  }
+  void on(const char *uri, HTTPMethod method, THandlerFunction handler) {
+    _routes.push_back({uri, method, handler, nullptr});
+  }
+  void on(const char *uri, HTTPMethod method, THandlerFunction handler,
+          THandlerFunction upload) {
+    _routes.push_back({uri, method, handler, upload});
+  }
+  void onNotFound(THandlerFunction handler) { _notFound = handler; }
+  void collectHeaders(const char *[], size_t) {}
+
+  // --- Request ---
+  bool hasArg(const String &name) {
+    return requestArgs.count(name.c_str()) > 0;
+  }
+  String arg(const String &name);
+  int args() { return requestArgs.size(); }
+  String header(const String &name);
+  bool hasHeader(const String &name) {
+    return requestHeaders.count(name.c_str()) > 0;
+  }
+  String uri() { return String(_uri); }
+  HTTPMethod method() { return requestMethod; }
+  WiFiClient &client() { return requestClient; }
+  HTTPUpload &upload() { return _upload; }
+
+  // --- Response ---
+  void send(int code, const char *type = nullptr,
+            const String &content = String());
+  void send(int code, const char *type, const char *content) {
+    send(code, type, String(content));
+  }
+  void send_P(int code, PGM_P type, PGM_P content) {
+    send(code, type, content);
+  }
+  void send_P(int code, PGM_P type, PGM_P content, size_t len);
+  void sendHeader(const String &name, const String &value,
+                  bool first = false);
+  void setContentLength(size_t len) { _contentLength = len; }
+  void sendContent(const String &content) {
+    sendContent(content.c_str(), content.length());
+  }
+  void sendContent(const char *content, size_t len);
+  void sendContent_P(PGM_P content) { sendContent(content, strlen(content)); }
+  void sendContent_P(PGM_P content, size_t len) { sendContent(content, len); }
+
+  // Clears the last response and runs the handler registered for uri;
+  // false when no route matches
+  bool request(const char *uri, HTTPMethod method = HTTP_GET);
+
+  // The request a test sets up
+  std::map<std::string, std::string> requestArgs;
+  std::map<std::string, std::string> requestHeaders;
+  HTTPMethod requestMethod = HTTP_GET;
+  WiFiClient requestClient;
+
+  // What the last handler sent
+  int status = 0;
+  std::string contentType;
+  std::vector<std::pair<std::string, std::string>> sentHeaders;
+  std::string body;
+  bool chunked = false;
+  bool finished = false; // chunked: the terminating chunk went out
+
+  std::string sentHeader(const char *name) const;
+
+private:
+  struct Route {
+    std::string uri;
+    HTTPMethod method;
+    THandlerFunction handler;
+    THandlerFunction upload;
+  };
+
+  int _port;
+  std::vector<Route> _routes;
+  THandlerFunction _notFound;
+  std::string _uri;
+  std::vector<String> _currentArgs; // held on the heap until the next one
+  size_t _contentLength = CONTENT_LENGTH_NOT_SET;
+  HTTPUpload _upload = {};
+};
+
+#endif
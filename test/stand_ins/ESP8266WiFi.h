@@ -0,0 +1,178 @@
+#ifndef STAND_IN_ESP8266WIFI_H
+#define STAND_IN_ESP8266WIFI_H
+
+#include <Arduino.h>
+
+#include <deque>
+#include <memory>
+#include <vector>
+
+#define WL_IDLE_STATUS 0
+#define WL_NO_SSID_AVAIL 1
+#define WL_CONNECTED 3
+#define WL_CONNECT_FAILED 4
+#define WL_WRONG_PASSWORD 6
+#define WL_DISCONNECTED 7
+#define WIFI_SCAN_RUNNING (-1)
+#define WIFI_SCAN_FAILED (-2)
+
+typedef int wl_status_t;
+enum WiFiMode_t { WIFI_OFF, WIFI_STA, WIFI_AP, WIFI_AP_STA };
+
+// --- Loopback Sockets ---
+// A connection between a device-side WiFiClient and a host-side peer the
+// test provides. Bytes the peer sends arrive as segments, each visible from
+// a given millis(); like lwIP's pbufs, peekBuffer() only spans one segment.
+struct StandInSegment {
+  std::string data;
+  unsigned long at; // millis() from which the device sees it
+};
+
+class StandInHost;
+
+struct StandInSocket {
+  std::string tx; // written by the device, not yet taken by the peer
+  std::deque<StandInSegment> rx;
+  size_t rxOffset = 0; // into rx.front()
+  bool open = true;    // device side
+  bool peerOpen = true;
+  size_t writeLimit = (size_t)-1; // bytes the send buffer accepts per write
+  StandInHost *host = nullptr;
+
+  // Queues bytes for the device, visible after delayMs
+  void send(const char *data, size_t len, unsigned long delayMs = 0);
+  void send(const std::string &data, unsigned long delayMs = 0) {
+    send(data.data(), data.size(), delayMs);
+  }
+  size_t visible() const; // bytes the device can read now
+};
+
+// Host side of a loopback address, e.g. a fake Transmission server
+class StandInHost {
+public:
+  virtual ~StandInHost() {}
+  virtual bool accept(StandInSocket &) { return true; }
+  virtual void receive(StandInSocket &socket) = 0; // socket.tx has data
+};
+
+void standInListen(const char *host, uint16_t port, StandInHost *peer);
+unsigned long standInConnects(); // successful connect() calls so far
+
+class Client : public Stream {
+public:
+  virtual int connect(const char *host, uint16_t port) = 0;
+  virtual uint8_t connected() = 0;
+  virtual void stop() = 0;
+};
+
+class WiFiClient : public Client {
+public:
+  WiFiClient() {}
+  explicit WiFiClient(std::shared_ptr<StandInSocket> socket)
+      : _socket(socket) {}
+
+  int connect(const char *host, uint16_t port) override;
+  int connect(const String &host, uint16_t port) {
+    return connect(host.c_str(), port);
+  }
+  uint8_t connected() override;
+  void stop() override;
+  explicit operator bool() const { return _socket && _socket->open; }
+
+  size_t write(uint8_t c) override { return write(&c, 1); }
+  size_t write(const uint8_t *buf, size_t n) override;
+  using Print::write;
+  size_t availableForWrite() { return _socket ? _socket->writeLimit : 0; }
+
+  int available() override;
+  int read() override;
+  int read(uint8_t *buf, size_t n);
+  int peek() override;
+  size_t peekAvailable();
+  const char *peekBuffer();
+  void peekConsume(size_t n);
+
+  void setNoDelay(bool) {}
+  void setSync(bool) {}
+  void keepAlive(uint16_t = 7200, uint16_t = 75, uint8_t = 9) {}
+  IPAddress remoteIP() { return IPAddress(192, 168, 1, 2); }
+
+  StandInSocket *socket() { return _socket.get(); } // for tests
+
+private:
+  std::shared_ptr<StandInSocket> _socket;
+};
+
+// --- WiFi ---
+struct StandInNetwork {
+  String ssid;
+  int32_t rssi;
+  uint8_t bssid[6];
+  int32_t channel;
+};
+
+class ESP8266WiFiClass {
+public:
+  void mode(WiFiMode_t m) { _mode = m; }
+  WiFiMode_t getMode() { return _mode; }
+  int begin(const char *ssid, const char *pass = nullptr, int32_t channel = 0,
+            const uint8_t *bssid = nullptr, bool connect = true);
+  int begin(const String &ssid, const String &pass, int32_t channel = 0,
+            const uint8_t *bssid = nullptr, bool connect = true) {
+    return begin(ssid.c_str(), pass.c_str(), channel, bssid, connect);
+  }
+  bool config(IPAddress, IPAddress, IPAddress, IPAddress = IPAddress(),
+              IPAddress = IPAddress()) {
+    return true;
+  }
+  bool disconnect(bool = false);
+  bool reconnect() { return true; }
+  wl_status_t status() { return _status; }
+  bool softAP(const char *, const char * = nullptr) { return true; }
+  bool softAPdisconnect(bool = false) { return true; }
+  IPAddress softAPIP() { return IPAddress(192, 168, 4, 1); }
+  IPAddress localIP() { return connectedIP(ip); }
+  IPAddress gatewayIP() { return connectedIP(IPAddress(192, 168, 1, 1)); }
+  IPAddress subnetMask() { return connectedIP(IPAddress(255, 255, 255, 0)); }
+  IPAddress dnsIP(uint8_t = 0) { return gatewayIP(); }
+  String SSID() { return _status == WL_CONNECTED ? _ssid : String(); }
+  String macAddress() { return "5C:CF:7F:00:00:01"; }
+  uint8_t *macAddress(uint8_t *mac);
+  int32_t RSSI() { return _status == WL_CONNECTED ? rssi : 31; }
+  int32_t channel() { return 6; }
+  uint8_t *BSSID() { return _bssid; }
+
+  // Scans finish at once: scanComplete() already has the results
+  int8_t scanNetworks(bool async = false, bool showHidden = false);
+  int8_t scanComplete();
+  void scanDelete() { _scanState = WIFI_SCAN_FAILED; }
+  String SSID(uint8_t i) { return scanResults[i].ssid; }
+  int32_t RSSI(uint8_t i) { return scanResults[i].rssi; }
+  int32_t channel(uint8_t i) { return scanResults[i].channel; }
+  uint8_t *BSSID(uint8_t i) { return scanResults[i].bssid; }
+
+  void persistent(bool) {}
+  void setAutoReconnect(bool) {}
+  bool setAutoConnect(bool) { return true; }
+  bool hostname(const char *) { return true; }
+
+  // What the next begin() leads to, and the link it reports
+  wl_status_t joinResult = WL_CONNECTED;
+  int32_t rssi = -55;
+  IPAddress ip = IPAddress(192, 168, 1, 50);
+  std::vector<StandInNetwork> scanResults;
+
+private:
+  IPAddress connectedIP(IPAddress v) {
+    return _status == WL_CONNECTED ? v : IPAddress();
+  }
+
+  WiFiMode_t _mode = WIFI_OFF;
+  wl_status_t _status = WL_DISCONNECTED;
+  String _ssid;
+  uint8_t _bssid[6] = {0x5C, 0xCF, 0x7F, 0x10, 0x20, 0x30};
+  int8_t _scanState = WIFI_SCAN_FAILED;
+};
+extern ESP8266WiFiClass WiFi;
+
+#endif
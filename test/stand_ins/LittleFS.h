@@ -0,0 +1,64 @@
+#ifndef STAND_IN_LITTLEFS_H
+#define STAND_IN_LITTLEFS_H
+
+#include <Arduino.h>
+
+#include <map>
+#include <memory>
+
+// In-memory LittleFS. Like the real one, a file's data is committed when it
+// is closed and rename() is atomic. powerCut() models losing power after a
+// number of written bytes: the write that crosses it comes up short, data
+// not yet committed is lost, and every call fails until powerRestore().
+
+struct StandInOpenFile;
+
+class File : public Stream {
+public:
+  File() {}
+  explicit File(std::shared_ptr<StandInOpenFile> open) : _open(open) {}
+
+  size_t write(uint8_t c) override { return write(&c, 1); }
+  size_t write(const uint8_t *buf, size_t n) override;
+  using Print::write;
+  int available() override;
+  int read() override;
+  int peek() override;
+  size_t read(uint8_t *buf, size_t n);
+  size_t size();
+  void close();
+  explicit operator bool() const { return _open != nullptr; }
+
+private:
+  std::shared_ptr<StandInOpenFile> _open;
+};
+
+class FS {
+public:
+  bool begin() { return !_off; }
+  void end() {}
+  bool exists(const char *path);
+  File open(const char *path, const char *mode);
+  bool remove(const char *path);
+  bool rename(const char *from, const char *to);
+  bool format();
+
+  // --- Test hooks ---
+  void powerCut(size_t afterBytes) { _budget = afterBytes; }
+  void powerRestore();
+  bool powerLost() const { return _off; }
+
+  std::map<std::string, std::string> files; // committed contents
+  unsigned long bytesWritten = 0;             // since the last format()
+  unsigned long commits = 0;                  // closes of written files
+
+private:
+  friend class File;
+  size_t takeBudget(size_t n);
+
+  size_t _budget = (size_t)-1;
+  bool _off = false;
+};
+extern FS LittleFS;
+
+#endif
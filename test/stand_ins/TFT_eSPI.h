@@ -0,0 +1,166 @@
+#ifndef STAND_IN_TFT_ESPI_H
+#define STAND_IN_TFT_ESPI_H
+
+// Simulated ILI9341: the panel is a 240 x 320 RGB565 framebuffer, and every
+// transfer to it is accounted the way it goes over SPI, one address window
+// (CASET/PASET/RAMWR, 11 bytes) plus 2 bytes per pixel. Sprites draw into
+// their own buffer and only cost bus time when pushed. Drawing follows
+// TFT_eSPI closely enough that the windows match: clipping, the GLCD font
+// (one window per character with a background at size 1, a fillRect per
+// font pixel otherwise), pushImage byte order, 8-bit sprite colours and
+// pushSprite() of a rectangle narrower than the sprite as a window per row.
+
+#include <Arduino.h>
+
+#include <vector>
+
+#define TFT_WIDTH 240
+#define TFT_HEIGHT 320
+
+#define TFT_BLACK 0x0000
+#define TFT_NAVY 0x000F
+#define TFT_DARKGREEN 0x03E0
+#define TFT_DARKGREY 0x7BEF
+#define TFT_LIGHTGREY 0xD69A
+#define TFT_BLUE 0x001F
+#define TFT_GREEN 0x07E0
+#define TFT_CYAN 0x07FF
+#define TFT_RED 0xF800
+#define TFT_MAGENTA 0xF81F
+#define TFT_YELLOW 0xFFE0
+#define TFT_WHITE 0xFFFF
+#define TFT_ORANGE 0xFDA0
+
+#define TL_DATUM 0
+#define TC_DATUM 1
+#define TR_DATUM 2
+#define MC_DATUM 4
+
+#ifndef SPI_FREQUENCY
+#define SPI_FREQUENCY 27000000
+#endif
+
+// Bus traffic to the panel
+struct StandInSpi {
+  unsigned long windows;
+  unsigned long pixels;
+  unsigned long bytes;
+
+  uint64_t micros() const {
+    return (uint64_t)bytes * 8 * 1000000 / SPI_FREQUENCY;
+  }
+};
+
+class TFT_eSPI : public Print {
+public:
+  TFT_eSPI(int16_t w = TFT_WIDTH, int16_t h = TFT_HEIGHT);
+  virtual ~TFT_eSPI() {}
+
+  void init();
+  void setRotation(uint8_t r); // 0/2 portrait, 1/3 landscape
+  int16_t width() { return _width; }
+  int16_t height() { return _height; }
+
+  void fillScreen(uint32_t color) { fillRect(0, 0, _width, _height, color); }
+  virtual void fillRect(int32_t x, int32_t y, int32_t w, int32_t h,
+                        uint32_t color);
+  virtual void drawPixel(int32_t x, int32_t y, uint32_t color);
+  virtual void drawFastHLine(int32_t x, int32_t y, int32_t w,
+                             uint32_t color);
+  virtual void drawFastVLine(int32_t x, int32_t y, int32_t h,
+                             uint32_t color);
+  void drawRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color);
+  void fillRoundRect(int32_t x, int32_t y, int32_t w, int32_t h, int32_t r,
+                     uint32_t color);
+  virtual void drawChar(int32_t x, int32_t y, uint16_t c, uint32_t color,
+                        uint32_t bg, uint8_t size);
+  void pushImage(int32_t x, int32_t y, int32_t w, int32_t h,
+                 const uint16_t *data);
+  void pushImage(int32_t x, int32_t y, int32_t w, int32_t h, uint8_t *data,
+                 bool bpp8 = true); // RGB332, expanded like 8-bit sprites
+
+  void setSwapBytes(bool swap) { _swapBytes = swap; }
+  bool getSwapBytes() { return _swapBytes; }
+  void setCursor(int16_t x, int16_t y) {
+    _cursorX = x;
+    _cursorY = y;
+  }
+  void setTextColor(uint16_t fg) { setTextColor(fg, fg); }
+  void setTextColor(uint16_t fg, uint16_t bg) {
+    _textColor = fg;
+    _textBg = bg;
+  }
+  void setTextSize(uint8_t size) { _textSize = size ? size : 1; }
+  void startWrite() {}
+  void endWrite() {}
+
+  size_t write(uint8_t c) override;
+  using Print::write;
+
+  // --- Simulator ---
+  uint16_t readPixel(int32_t x, int32_t y); // as the panel shows it
+  bool dumpPPM(const char *path);           // binary PPM (P6), 8 bits/channel
+  StandInSpi spi = {0, 0, 0};
+
+protected:
+  friend class TFT_eSprite;
+
+  // Fills the clipped rectangle from colors (w per row) or with one color,
+  // as a single window on the panel
+  void writeRect(int32_t x, int32_t y, int32_t w, int32_t h,
+                 const uint16_t *colors, uint16_t fill);
+  void fillCircleHelper(int32_t x0, int32_t y0, int32_t r, uint8_t corner,
+                        int32_t delta, uint32_t color);
+  virtual void countWindow(uint32_t pixels);
+  virtual bool ready() { return !_pixels.empty(); }
+  virtual void storePixel(size_t i, uint16_t color) { _pixels[i] = color; }
+  virtual uint16_t loadPixel(size_t i) { return _pixels[i]; }
+
+  int16_t _width, _height;
+  std::vector<uint16_t> _pixels;
+  int16_t _cursorX = 0, _cursorY = 0;
+  uint16_t _textColor = TFT_WHITE, _textBg = TFT_WHITE;
+  uint8_t _textSize = 1;
+  bool _swapBytes = false;
+};
+
+class TFT_eSprite : public TFT_eSPI {
+public:
+  explicit TFT_eSprite(TFT_eSPI *tft) : TFT_eSPI(0, 0), _tft(tft) {}
+
+  void *setColorDepth(int8_t depth);
+  int8_t getColorDepth() { return created() ? _depth : 0; }
+  void *createSprite(int16_t w, int16_t h, uint8_t frames = 1);
+  void deleteSprite();
+  bool created() { return !_mem.empty(); }
+  void *getPointer() { return created() ? _mem.data() : nullptr; }
+  void fillSprite(uint32_t color) { fillRect(0, 0, _width, _height, color); }
+  void pushSprite(int32_t x, int32_t y);
+  bool pushSprite(int32_t tx, int32_t ty, int32_t sx, int32_t sy, int32_t sw,
+                  int32_t sh);
+  void pushImage(int32_t x, int32_t y, int32_t w, int32_t h,
+                 const uint16_t *data);
+
+  // Sprite RAM the firmware would have taken from the heap
+  static size_t bytesAllocated;
+
+protected:
+  void countWindow(uint32_t) override {} // off-screen, no bus traffic
+  bool ready() override { return created(); }
+  void storePixel(size_t i, uint16_t color) override;
+  uint16_t loadPixel(size_t i) override;
+  void pushRect(int32_t tx, int32_t ty, int32_t sx, int32_t sy, int32_t sw,
+                int32_t sh);
+
+  TFT_eSPI *_tft;
+  int8_t _depth = 16;
+  // The sprite's RAM as TFT_eSPI lays it out: RGB565 high byte first, or
+  // one RGB332 byte per pixel
+  std::vector<uint8_t> _mem;
+};
+
+// RGB332 as TFT_eSPI's 8-bit sprites hold it
+uint8_t standInColor16to8(uint16_t color);
+uint16_t standInColor8to16(uint8_t color);
+
+#endif
@@ -0,0 +1,206 @@
+#include <Arduino.h>
+#include <coredecls.h>
+
+#include <chrono>
+
+HardwareSerial Serial;
+EspClass ESP;
+
+#if !defined(__GLIBC__) || !__GLIBC_PREREQ(2, 38)
+size_t strlcpy(char *dst, const char *src, size_t size) {
+  size_t len = strlen(src);
+  if (size) {
+    size_t n = len < size - 1 ? len : size - 1;
+    memcpy(dst, src, n);
+    dst[n] = '\0';
+  }
+  return len;
+}
+#endif
+
+uint32_t crc32(const void *data, size_t length, uint32_t crc) {
+  const uint8_t *p = (const uint8_t *)data;
+  while (length--) {
+    uint8_t c = *p++;
+    for (uint32_t i = 0x80; i > 0; i >>= 1) {
+      bool bit = crc & 0x80000000;
+      if (c & i)
+        bit = !bit;
+      crc <<= 1;
+      if (bit)
+        crc ^= 0x04c11db7;
+    }
+  }
+  return crc;
+}
+
+// --- Time ---
+
+static unsigned long long skewUs = 0;
+
+static unsigned long long hostMicros() {
+  using namespace std::chrono;
+  static const steady_clock::time_point start = steady_clock::now();
+  return duration_cast<microseconds>(steady_clock::now() - start).count();
+}
+
+unsigned long millis() { return (hostMicros() + skewUs) / 1000; }
+
+unsigned long micros() { return hostMicros() + skewUs; }
+
+void delay(unsigned long ms) { standInAdvance(ms); }
+
+void yield() {}
+
+void standInAdvance(unsigned long ms) { skewUs += ms * 1000ULL; }
+
+void pinMode(int, int) {}
+
+void digitalWrite(int, int) {}
+
+// --- String ---
+
+String::String(float v, int decimals) : String((double)v, decimals) {}
+
+String::String(double v, int decimals) {
+  char buf[32];
+  snprintf(buf, sizeof(buf), "%.*f", decimals, v);
+  _s = buf;
+}
+
+int String::indexOf(const char *s) const {
+  size_t i = _s.find(s);
+  return i == std::string::npos ? -1 : (int)i;
+}
+
+int String::indexOf(char c) const {
+  size_t i = _s.find(c);
+  return i == std::string::npos ? -1 : (int)i;
+}
+
+String String::substring(unsigned from, unsigned to) const {
+  if (from > _s.size())
+    return String();
+  if (to > _s.size())
+    to = _s.size();
+  return String(_s.substr(from, to > from ? to - from : 0));
+}
+
+void String::trim() {
+  size_t first = _s.find_first_not_of(" \t\r\n");
+  size_t last = _s.find_last_not_of(" \t\r\n");
+  _s = first == std::string::npos ? "" : _s.substr(first, last - first + 1);
+}
+
+void String::replace(const char *from, const String &to) {
+  size_t n = strlen(from);
+  if (!n)
+    return;
+  for (size_t i = _s.find(from); i != std::string::npos;
+       i = _s.find(from, i + to.length()))
+    _s.replace(i, n, to.c_str());
+}
+
+String IPAddress::toString() const {
+  char buf[16];
+  snprintf(buf, sizeof(buf), "%u.%u.%u.%u", (*this)[0], (*this)[1],
+           (*this)[2], (*this)[3]);
+  return String(buf);
+}
+
+// --- Print / Stream ---
+
+size_t Print::write(const uint8_t *buf, size_t n) {
+  size_t written = 0;
+  while (written < n && write(buf[written]))
+    written++;
+  return written;
+}
+
+static size_t vprint(Print &out, const char *format, va_list args) {
+  char buf[256];
+  int len = vsnprintf(buf, sizeof(buf), format, args);
+  if (len < 0)
+    return 0;
+  return out.write((const uint8_t *)buf, min((size_t)len, sizeof(buf) - 1));
+}
+
+size_t Print::printf(const char *format, ...) {
+  va_list args;
+  va_start(args, format);
+  size_t n = vprint(*this, format, args);
+  va_end(args);
+  return n;
+}
+
+size_t Print::printf_P(const char *format, ...) {
+  va_list args;
+  va_start(args, format);
+  size_t n = vprint(*this, format, args);
+  va_end(args);
+  return n;
+}
+
+int Stream::timedRead() {
+  unsigned long start = millis();
+  do {
+    int c = read();
+    if (c >= 0)
+      return c;
+    yield();
+  } while (millis() - start < _timeout);
+  return -1;
+}
+
+size_t Stream::readBytes(char *buf, size_t n) {
+  size_t count = 0;
+  while (count < n) {
+    int c = timedRead();
+    if (c < 0)
+      break;
+    buf[count++] = (char)c;
+  }
+  return count;
+}
+
+String Stream::readStringUntil(char terminator) {
+  String s;
+  for (int c = timedRead(); c >= 0 && c != terminator; c = timedRead())
+    s += (char)c;
+  return s;
+}
+
+String Stream::readString() {
+  String s;
+  for (int c = timedRead(); c >= 0; c = timedRead())
+    s += (char)c;
+  return s;
+}
+
+size_t HardwareSerial::write(uint8_t c) {
+  if (echo)
+    fputc(c, stdout);
+  return 1;
+}
+
+// --- ESP ---
+
+uint32_t EspClass::getCycleCount() {
+  return (uint32_t)(micros() * getCpuFreqMHz());
+}
+
+bool EspClass::rtcUserMemoryRead(uint32_t offset, uint32_t *data,
+                                 size_t size) {
+  if (offset * 4 + size > sizeof(rtc))
+    return false;
+  memcpy(data, rtc + offset * 4, size);
+  return true;
+}
+
+bool EspClass::rtcUserMemoryWrite(uint32_t offset, uint32_t *data,
+                                  size_t size) {
+  if (offset * 4 + size > sizeof(rtc))
+    return false;
+  memcpy(rtc + offset * 4, data, size);
+  return true;
+}
@@ -0,0 +1,10 @@
+#ifndef STAND_IN_COREDECLS_H
+#define STAND_IN_COREDECLS_H
+
+#include <Arduino.h>
+
+// Same CRC as the core's: polynomial 0x04c11db7, MSB first, no final XOR,
+// so records written on the host read back on the device and vice versa
+uint32_t crc32(const void *data, size_t length, uint32_t crc = 0xffffffff);
+
+#endif
@@ -0,0 +1,108 @@
+#include "fake_transmission.h"
+
+static std::string header(const std::string &head, const char *name) {
+  std::string key = std::string("\r\n") + name + ":";
+  size_t i = head.find(key);
+  if (i == std::string::npos)
+    return std::string();
+  i += key.size();
+  while (i < head.size() && head[i] == ' ')
+    i++;
+  return head.substr(i, head.find("\r\n", i) - i);
+}
+
+static std::string statsReply(uint32_t down, uint32_t up) {
+  char buf[256];
+  snprintf(buf, sizeof(buf),
+           "{\"arguments\":{\"activeTorrentCount\":1,\"downloadSpeed\":%lu,"
+           "\"pausedTorrentCount\":0,\"torrentCount\":1,\"uploadSpeed\":%lu},"
+           "\"result\":\"success\"}",
+           (unsigned long)down, (unsigned long)up);
+  return buf;
+}
+
+FakeTransmission::FakeTransmission(const char *host, uint16_t port)
+    : _host(host), _port(port) {
+  standInListen(host, port, this);
+}
+
+FakeTransmission::~FakeTransmission() {
+  standInListen(_host.c_str(), _port, nullptr);
+}
+
+bool FakeTransmission::accept(StandInSocket &) { return !refuse; }
+
+void FakeTransmission::receive(StandInSocket &socket) {
+  for (;;) {
+    size_t end = socket.tx.find("\r\n\r\n");
+    if (end == std::string::npos)
+      return;
+    std::string head = socket.tx.substr(0, end + 2);
+    size_t length = atol(header(head, "Content-Length").c_str());
+    if (socket.tx.size() < end + 4 + length)
+      return; // the payload is still being written
+    std::string payload = socket.tx.substr(end + 4, length);
+    socket.tx.erase(0, end + 4 + length);
+
+    if (header(head, "X-Transmission-Session-Id") != sessionId) {
+      handshakes++;
+      respond(socket, "409 Conflict",
+              "<h1>409: Conflict</h1><p>Your request had an invalid session"
+              "-id header.</p>",
+              true);
+      continue;
+    }
+
+    requests++;
+    lastPayload = payload;
+    lastAuthorization = header(head, "Authorization");
+    std::string body;
+    if (reply)
+      body = reply(payload);
+    else if (payload.find("session-stats") != std::string::npos)
+      body = statsReply(downloadSpeed, uploadSpeed);
+    else
+      body = "{\"arguments\":{\"torrents\":[]},\"result\":\"success\"}";
+    respond(socket, "200 OK", body, false);
+  }
+}
+
+void FakeTransmission::respond(StandInSocket &socket,
+                               const std::string &status,
+                               const std::string &body, bool sessionHeader) {
+  std::string out = "HTTP/1.1 " + status + "\r\nServer: Transmission\r\n";
+  if (sessionHeader)
+    out += "X-Transmission-Session-Id: " + sessionId + "\r\n";
+  out += "Content-Type: application/json; charset=UTF-8\r\n";
+  if (!keepAlive)
+    out += "Connection: close\r\n";
+  if (chunked) {
+    out += "Transfer-Encoding: chunked\r\n\r\n";
+    // One chunk per 100 bytes, like a server flushing as it goes
+    for (size_t i = 0; i < body.size(); i += 100) {
+      std::string part = body.substr(i, 100);
+      char size[16];
+      snprintf(size, sizeof(size), "%zx\r\n", part.size());
+      out += size + part + "\r\n";
+    }
+    out += "0\r\n\r\n";
+  } else {
+    out += "Content-Length: " + std::to_string(body.size()) + "\r\n\r\n";
+    out += body;
+  }
+
+  // Segments queue behind whatever the socket still holds
+  unsigned long at = latency;
+  if (!socket.rx.empty()) {
+    long queued = (long)(socket.rx.back().at - millis());
+    if (queued > (long)at)
+      at = queued;
+  }
+  size_t step = segment ? segment : out.size();
+  for (size_t i = 0; i < out.size(); i += step) {
+    socket.send(out.substr(i, step), at);
+    at += gap;
+  }
+  if (!keepAlive)
+    socket.peerOpen = false;
+}
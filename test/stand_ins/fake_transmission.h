@@ -0,0 +1,50 @@
+#ifndef STAND_IN_FAKE_TRANSMISSION_H
+#define STAND_IN_FAKE_TRANSMISSION_H
+
+#include <ESP8266WiFi.h>
+
+#include <functional>
+
+// A Transmission daemon behind the loopback sockets. It answers a request
+// without X-Transmission-Session-Id (or with a stale one) with the 409
+// handshake, and real ones with the reply the test configured for the RPC
+// method. Replies can be cut into segments spread out in time, to see how
+// the client copes with a body that trickles in.
+class FakeTransmission : public StandInHost {
+public:
+  FakeTransmission(const char *host = "192.168.1.2", uint16_t port = 9091);
+  ~FakeTransmission();
+
+  bool accept(StandInSocket &socket) override;
+  void receive(StandInSocket &socket) override;
+
+  // Reply body per RPC method; the default is session-stats with the
+  // speeds below and torrent-get with no torrents
+  std::function<std::string(const std::string &payload)> reply;
+  uint32_t downloadSpeed = 1843200;
+  uint32_t uploadSpeed = 524288;
+
+  // --- Delivery ---
+  bool chunked = false;
+  bool keepAlive = true;
+  bool refuse = false;       // connect() fails
+  size_t segment = 0;        // bytes per segment, 0 = one segment
+  unsigned long latency = 0; // ms before the first byte
+  unsigned long gap = 0;     // ms between segments
+
+  // --- Counters ---
+  unsigned long requests = 0;
+  unsigned long handshakes = 0;
+  std::string lastPayload;
+  std::string lastAuthorization; // of the last request answered
+  std::string sessionId = "fakeSessionIdO3Ng2YLgXHl5zJ1vBm8q";
+
+private:
+  void respond(StandInSocket &socket, const std::string &status,
+               const std::string &body, bool sessionHeader);
+
+  std::string _host;
+  uint16_t _port;
+};
+
+#endif
@@ -0,0 +1,107 @@
+#include <Arduino.h>
+
+#include <iterator>
+#include <map>
+
+// The arena is cut into 8-byte blocks like umm_malloc's. An allocation
+// takes a 4-byte header plus its data, rounded up to whole blocks, from
+// the smallest free run it fits (umm's best fit, lowest address first);
+// frees merge with free neighbours.
+#define HEAP_BLOCK 8
+#define HEAP_HEADER 4
+#define HEAP_BLOCKS (STAND_IN_HEAP_BYTES / HEAP_BLOCK)
+
+typedef std::map<size_t, size_t> Runs; // first block -> blocks
+
+alignas(HEAP_BLOCK) static uint8_t arena[STAND_IN_HEAP_BYTES];
+static unsigned long allocCount = 0;
+
+// Never destroyed: Strings with static storage may be freed after main()
+static Runs &freeRuns() {
+  static Runs *runs = new Runs{{0, HEAP_BLOCKS}};
+  return *runs;
+}
+
+static Runs &usedRuns() {
+  static Runs *runs = new Runs;
+  return *runs;
+}
+
+void *standInMalloc(size_t size) {
+  size_t blocks = (size + HEAP_HEADER + HEAP_BLOCK - 1) / HEAP_BLOCK;
+  Runs &free = freeRuns();
+  Runs::iterator best = free.end();
+  for (Runs::iterator it = free.begin(); it != free.end(); ++it) {
+    if (it->second >= blocks &&
+        (best == free.end() || it->second < best->second))
+      best = it;
+  }
+  if (best == free.end())
+    return nullptr;
+
+  size_t start = best->first;
+  size_t run = best->second;
+  free.erase(best);
+  if (run > blocks)
+    free[start + blocks] = run - blocks;
+  usedRuns()[start] = blocks;
+  allocCount++;
+  return arena + start * HEAP_BLOCK + HEAP_HEADER;
+}
+
+void standInFree(void *p) {
+  if (!p)
+    return;
+  size_t start = ((uint8_t *)p - arena - HEAP_HEADER) / HEAP_BLOCK;
+  Runs::iterator used = usedRuns().find(start);
+  if (used == usedRuns().end())
+    abort(); // not from this heap, or freed twice
+  size_t blocks = used->second;
+  usedRuns().erase(used);
+
+  Runs &free = freeRuns();
+  Runs::iterator next = free.lower_bound(start);
+  if (next != free.end() && next->first == start + blocks) {
+    blocks += next->second;
+    next = free.erase(next);
+  }
+  if (next != free.begin()) {
+    Runs::iterator prev = std::prev(next);
+    if (prev->first + prev->second == start) {
+      prev->second += blocks;
+      return;
+    }
+  }
+  free[start] = blocks;
+}
+
+unsigned long standInHeapAllocs() { return allocCount; }
+
+// --- ESP ---
+
+uint32_t EspClass::getFreeHeap() {
+  size_t blocks = 0;
+  for (const Runs::value_type &run : freeRuns())
+    blocks += run.second;
+  return blocks * HEAP_BLOCK;
+}
+
+uint32_t EspClass::getMaxFreeBlockSize() {
+  size_t blocks = 0;
+  for (const Runs::value_type &run : freeRuns())
+    blocks = max(blocks, run.second);
+  return blocks * HEAP_BLOCK;
+}
+
+// umm_fragmentation_metric(): 0 when all free memory is one run, towards
+// 100 as it splits into many small ones
+uint8_t EspClass::getHeapFragmentation() {
+  double blocks = 0, squares = 0;
+  for (const Runs::value_type &run : freeRuns()) {
+    blocks += run.second;
+    squares += (double)run.second * run.second;
+  }
+  if (!blocks)
+    return 0;
+  return 100 - (uint32_t)sqrt(squares) * 100 / (uint32_t)blocks;
+}
@@ -0,0 +1,129 @@
+#include <LittleFS.h>
+
+FS LittleFS;
+
+struct StandInOpenFile {
+  std::string path;
+  std::string data;
+  size_t pos = 0;
+  bool writable = false;
+  bool dirty = false;
+  bool closed = false;
+};
+
+// --- File ---
+
+size_t File::write(const uint8_t *buf, size_t n) {
+  if (!_open || _open->closed || !_open->writable)
+    return 0;
+  n = LittleFS.takeBudget(n);
+  _open->data.replace(_open->pos, n, (const char *)buf, n);
+  _open->pos += n;
+  _open->dirty = true;
+  LittleFS.bytesWritten += n;
+  return n;
+}
+
+int File::available() {
+  if (!_open || _open->closed || LittleFS.powerLost())
+    return 0;
+  return _open->data.size() - _open->pos;
+}
+
+int File::read() {
+  uint8_t c;
+  return read(&c, 1) == 1 ? c : -1;
+}
+
+int File::peek() {
+  return available() ? (uint8_t)_open->data[_open->pos] : -1;
+}
+
+size_t File::read(uint8_t *buf, size_t n) {
+  n = min(n, (size_t)available());
+  if (n)
+    memcpy(buf, _open->data.data() + _open->pos, n);
+  if (_open)
+    _open->pos += n;
+  return n;
+}
+
+size_t File::size() { return _open ? _open->data.size() : 0; }
+
+void File::close() {
+  if (!_open || _open->closed)
+    return;
+  _open->closed = true;
+  if (_open->dirty && !LittleFS.powerLost()) {
+    LittleFS.files[_open->path] = _open->data;
+    LittleFS.commits++;
+  }
+  _open.reset();
+}
+
+// --- FS ---
+
+size_t FS::takeBudget(size_t n) {
+  if (_off)
+    return 0;
+  if (n >= _budget) {
+    n = _budget;
+    _budget = 0;
+    _off = true;
+    return n;
+  }
+  if (_budget != (size_t)-1)
+    _budget -= n;
+  return n;
+}
+
+void FS::powerRestore() {
+  _off = false;
+  _budget = (size_t)-1;
+}
+
+bool FS::exists(const char *path) { return !_off && files.count(path); }
+
+File FS::open(const char *path, const char *mode) {
+  if (_off)
+    return File();
+  auto open = std::make_shared<StandInOpenFile>();
+  open->path = path;
+  auto it = files.find(path);
+  if (mode[0] == 'r') {
+    if (it == files.end())
+      return File();
+    open->data = it->second;
+    open->writable = mode[1] == '+';
+  } else {
+    // "w" creates or truncates the entry at once; "a" keeps the data
+    open->writable = true;
+    if (mode[0] == 'a' && it != files.end())
+      open->data = it->second;
+    open->pos = open->data.size();
+    files[path] = open->data;
+  }
+  return File(open);
+}
+
+bool FS::remove(const char *path) {
+  return !_off && files.erase(path) > 0;
+}
+
+bool FS::rename(const char *from, const char *to) {
+  auto it = files.find(from);
+  if (_off || it == files.end())
+    return false;
+  std::string data = it->second;
+  files.erase(it);
+  files[to] = data;
+  return true;
+}
+
+bool FS::format() {
+  files.clear();
+  bytesWritten = 0;
+  commits = 0;
+  powerRestore();
+  return true;
+}
@@ -0,0 +1,8 @@
+// What main.cpp provides the modules on the device
+#include <TFT_eSPI.h>
+
+#include "display_utils.h"
+
+TFT_eSPI tft = TFT_eSPI();
+State currentState = STATE_CONNECTED;
+Screen currentScreen = SCREEN_SPEED;
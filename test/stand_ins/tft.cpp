@@ -0,0 +1,368 @@
+#include <TFT_eSPI.h>
+
+#define TFT_WINDOW_FRAMING 11 // CASET + PASET + RAMWR with their parameters
+
+// GLCD 5x7 font, printable ASCII; columns with bit 0 at the top
+static const uint8_t glcd[][5] = {
+    {0x00, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x5F, 0x00, 0x00},
+    {0x00, 0x07, 0x00, 0x07, 0x00}, {0x14, 0x7F, 0x14, 0x7F, 0x14},
+    {0x24, 0x2A, 0x7F, 0x2A, 0x12}, {0x23, 0x13, 0x08, 0x64, 0x62},
+    {0x36, 0x49, 0x56, 0x20, 0x50}, {0x00, 0x08, 0x07, 0x03, 0x00},
+    {0x00, 0x1C, 0x22, 0x41, 0x00}, {0x00, 0x41, 0x22, 0x1C, 0x00},
+    {0x2A, 0x1C, 0x7F, 0x1C, 0x2A}, {0x08, 0x08, 0x3E, 0x08, 0x08},
+    {0x00, 0x80, 0x70, 0x30, 0x00}, {0x08, 0x08, 0x08, 0x08, 0x08},
+    {0x00, 0x00, 0x60, 0x60, 0x00}, {0x20, 0x10, 0x08, 0x04, 0x02},
+    {0x3E, 0x51, 0x49, 0x45, 0x3E}, {0x00, 0x42, 0x7F, 0x40, 0x00},
+    {0x72, 0x49, 0x49, 0x49, 0x46}, {0x21, 0x41, 0x49, 0x4D, 0x33},
+    {0x18, 0x14, 0x12, 0x7F, 0x10}, {0x27, 0x45, 0x45, 0x45, 0x39},
+    {0x3C, 0x4A, 0x49, 0x49, 0x31}, {0x41, 0x21, 0x11, 0x09, 0x07},
+    {0x36, 0x49, 0x49, 0x49, 0x36}, {0x46, 0x49, 0x49, 0x29, 0x1E},
+    {0x00, 0x00, 0x14, 0x00, 0x00}, {0x00, 0x40, 0x34, 0x00, 0x00},
+    {0x00, 0x08, 0x14, 0x22, 0x41}, {0x14, 0x14, 0x14, 0x14, 0x14},
+    {0x00, 0x41, 0x22, 0x14, 0x08}, {0x02, 0x01, 0x59, 0x09, 0x06},
+    {0x3E, 0x41, 0x5D, 0x59, 0x4E}, {0x7C, 0x12, 0x11, 0x12, 0x7C},
+    {0x7F, 0x49, 0x49, 0x49, 0x36}, {0x3E, 0x41, 0x41, 0x41, 0x22},
+    {0x7F, 0x41, 0x41, 0x41, 0x3E}, {0x7F, 0x49, 0x49, 0x49, 0x41},
+    {0x7F, 0x09, 0x09, 0x09, 0x01}, {0x3E, 0x41, 0x41, 0x51, 0x73},
+    {0x7F, 0x08, 0x08, 0x08, 0x7F}, {0x00, 0x41, 0x7F, 0x41, 0x00},
+    {0x20, 0x40, 0x41, 0x3F, 0x01}, {0x7F, 0x08, 0x14, 0x22, 0x41},
+    {0x7F, 0x40, 0x40, 0x40, 0x40}, {0x7F, 0x02, 0x1C, 0x02, 0x7F},
+    {0x7F, 0x04, 0x08, 0x10, 0x7F}, {0x3E, 0x41, 0x41, 0x41, 0x3E},
+    {0x7F, 0x09, 0x09, 0x09, 0x06}, {0x3E, 0x41, 0x51, 0x21, 0x5E},
+    {0x7F, 0x09, 0x19, 0x29, 0x46}, {0x26, 0x49, 0x49, 0x49, 0x32},
+    {0x03, 0x01, 0x7F, 0x01, 0x03}, {0x3F, 0x40, 0x40, 0x40, 0x3F},
+    {0x1F, 0x20, 0x40, 0x20, 0x1F}, {0x3F, 0x40, 0x38, 0x40, 0x3F},
+    {0x63, 0x14, 0x08, 0x14, 0x63}, {0x03, 0x04, 0x78, 0x04, 0x03},
+    {0x61, 0x59, 0x49, 0x4D, 0x43}, {0x00, 0x7F, 0x41, 0x41, 0x41},
+    {0x02, 0x04, 0x08, 0x10, 0x20}, {0x00, 0x41, 0x41, 0x41, 0x7F},
+    {0x04, 0x02, 0x01, 0x02, 0x04}, {0x40, 0x40, 0x40, 0x40, 0x40},
+    {0x00, 0x03, 0x07, 0x08, 0x00}, {0x20, 0x54, 0x54, 0x78, 0x40},
+    {0x7F, 0x28, 0x44, 0x44, 0x38}, {0x38, 0x44, 0x44, 0x44, 0x28},
+    {0x38, 0x44, 0x44, 0x28, 0x7F}, {0x38, 0x54, 0x54, 0x54, 0x18},
+    {0x00, 0x08, 0x7E, 0x09, 0x02}, {0x18, 0xA4, 0xA4, 0x9C, 0x78},
+    {0x7F, 0x08, 0x04, 0x04, 0x78}, {0x00, 0x44, 0x7D, 0x40, 0x00},
+    {0x20, 0x40, 0x40, 0x3D, 0x00}, {0x7F, 0x10, 0x28, 0x44, 0x00},
+    {0x00, 0x41, 0x7F, 0x40, 0x00}, {0x7C, 0x04, 0x78, 0x04, 0x78},
+    {0x7C, 0x08, 0x04, 0x04, 0x78}, {0x38, 0x44, 0x44, 0x44, 0x38},
+    {0xFC, 0x18, 0x24, 0x24, 0x18}, {0x18, 0x24, 0x24, 0x18, 0xFC},
+    {0x7C, 0x08, 0x04, 0x04, 0x08}, {0x48, 0x54, 0x54, 0x54, 0x24},
+    {0x04, 0x04, 0x3F, 0x44, 0x24}, {0x3C, 0x40, 0x40, 0x20, 0x7C},
+    {0x1C, 0x20, 0x40, 0x20, 0x1C}, {0x3C, 0x40, 0x30, 0x40, 0x3C},
+    {0x44, 0x28, 0x10, 0x28, 0x44}, {0x4C, 0x90, 0x90, 0x90, 0x7C},
+    {0x44, 0x64, 0x54, 0x4C, 0x44}, {0x00, 0x08, 0x36, 0x41, 0x00},
+    {0x00, 0x00, 0x77, 0x00, 0x00}, {0x00, 0x41, 0x36, 0x08, 0x00},
+    {0x02, 0x01, 0x02, 0x04, 0x02},
+};
+
+// Outside the table: a hollow box, so missing glyphs show in dumps
+static const uint8_t unknownGlyph[5] = {0x7F, 0x41, 0x41, 0x41, 0x7F};
+
+static const uint8_t *glyph(uint16_t c) {
+  return c >= 0x20 && c <= 0x7E ? glcd[c - 0x20] : unknownGlyph;
+}
+
+static uint16_t swap16(uint16_t v) { return v << 8 | v >> 8; }
+
+uint8_t standInColor16to8(uint16_t color) {
+  return (color & 0xE000) >> 8 | (color & 0x0700) >> 6 | (color & 0x0018) >> 3;
+}
+
+uint16_t standInColor8to16(uint8_t color) {
+  static const uint8_t blue[] = {0, 11, 21, 31};
+  uint16_t color16 = (color & 0xE0) << 8 | (color & 0xC0) << 5;
+  color16 |= (color & 0x1C) << 6 | (color & 0x1C) << 3;
+  return color16 | blue[color & 0x03];
+}
+
+// --- Panel ---
+
+TFT_eSPI::TFT_eSPI(int16_t w, int16_t h) : _width(w), _height(h) {}
+
+void TFT_eSPI::init() {
+  // Power-on RAM content is undefined; start from black
+  _pixels.assign((size_t)_width * _height, TFT_BLACK);
+}
+
+void TFT_eSPI::setRotation(uint8_t r) {
+  int16_t shortSide = min(_width, _height), longSide = max(_width, _height);
+  _width = r & 1 ? longSide : shortSide;
+  _height = r & 1 ? shortSide : longSide;
+  _pixels.assign((size_t)_width * _height, TFT_BLACK);
+}
+
+void TFT_eSPI::countWindow(uint32_t pixels) {
+  spi.windows++;
+  spi.pixels += pixels;
+  spi.bytes += TFT_WINDOW_FRAMING + pixels * 2;
+}
+
+void TFT_eSPI::writeRect(int32_t x, int32_t y, int32_t w, int32_t h,
+                         const uint16_t *colors, uint16_t fill) {
+  // Clip like TFT_eSPI: nothing at all goes out for an empty window
+  int32_t x0 = max<int32_t>(x, 0), y0 = max<int32_t>(y, 0);
+  int32_t x1 = min<int32_t>(x + w, _width), y1 = min<int32_t>(y + h, _height);
+  if (x0 >= x1 || y0 >= y1 || !ready())
+    return;
+  countWindow((x1 - x0) * (y1 - y0));
+  for (int32_t py = y0; py < y1; py++) {
+    for (int32_t px = x0; px < x1; px++) {
+      uint16_t c = colors ? colors[(py - y) * w + (px - x)] : fill;
+      storePixel(py * _width + px, c);
+    }
+  }
+}
+
+void TFT_eSPI::fillRect(int32_t x, int32_t y, int32_t w, int32_t h,
+                        uint32_t color) {
+  writeRect(x, y, w, h, nullptr, color);
+}
+
+void TFT_eSPI::drawPixel(int32_t x, int32_t y, uint32_t color) {
+  writeRect(x, y, 1, 1, nullptr, color);
+}
+
+void TFT_eSPI::drawFastHLine(int32_t x, int32_t y, int32_t w,
+                             uint32_t color) {
+  writeRect(x, y, w, 1, nullptr, color);
+}
+
+void TFT_eSPI::drawFastVLine(int32_t x, int32_t y, int32_t h,
+                             uint32_t color) {
+  writeRect(x, y, 1, h, nullptr, color);
+}
+
+void TFT_eSPI::drawRect(int32_t x, int32_t y, int32_t w, int32_t h,
+                        uint32_t color) {
+  drawFastHLine(x, y, w, color);
+  drawFastHLine(x, y + h - 1, w, color);
+  drawFastVLine(x, y + 1, h - 2, color);
+  drawFastVLine(x + w - 1, y + 1, h - 2, color);
+}
+
+void TFT_eSPI::fillRoundRect(int32_t x, int32_t y, int32_t w, int32_t h,
+                             int32_t r, uint32_t color) {
+  fillRect(x, y + r, w, h - r - r, color);
+  fillCircleHelper(x + r, y + h - r - 1, r, 1, w - r - r - 1, color);
+  fillCircleHelper(x + r, y + r, r, 2, w - r - r - 1, color);
+}
+
+// Same stepping as TFT_eSPI, one horizontal line per step
+void TFT_eSPI::fillCircleHelper(int32_t x0, int32_t y0, int32_t r,
+                                uint8_t corner, int32_t delta,
+                                uint32_t color) {
+  int32_t f = 1 - r, ddF_x = 1, ddF_y = -r - r, y = 0;
+  delta++;
+  while (y < r) {
+    if (f >= 0) {
+      if (corner & 1)
+        drawFastHLine(x0 - y, y0 + r, y + y + delta, color);
+      if (corner & 2)
+        drawFastHLine(x0 - y, y0 - r, y + y + delta, color);
+      r--;
+      ddF_y += 2;
+      f += ddF_y;
+    }
+    y++;
+    ddF_x += 2;
+    f += ddF_x;
+    if (corner & 1)
+      drawFastHLine(x0 - r, y0 + y, r + r + delta, color);
+    if (corner & 2)
+      drawFastHLine(x0 - r, y0 - y, r + r + delta, color);
+  }
+}
+
+void TFT_eSPI::drawChar(int32_t x, int32_t y, uint16_t c, uint32_t color,
+                        uint32_t bg, uint8_t size) {
+  const uint8_t *columns = glyph(c);
+  bool fillBg = bg != color;
+
+  if (fillBg && size == 1 && x >= 0 && y >= 0 && x + 6 <= _width &&
+      y + 8 <= _height) {
+    // The fast path: the whole cell as one window
+    uint16_t cell[6 * 8];
+    for (int i = 0; i < 6; i++) {
+      uint8_t line = i < 5 ? columns[i] : 0;
+      for (int j = 0; j < 8; j++)
+        cell[j * 6 + i] = line >> j & 1 ? color : bg;
+    }
+    writeRect(x, y, 6, 8, cell, 0);
+    return;
+  }
+
+  for (int i = 0; i < 6; i++) {
+    uint8_t line = i < 5 ? columns[i] : 0;
+    for (int j = 0; j < 8; j++, line >>= 1) {
+      if (line & 1)
+        fillRect(x + i * size, y + j * size, size, size, color);
+      else if (fillBg)
+        fillRect(x + i * size, y + j * size, size, size, bg);
+    }
+  }
+}
+
+void TFT_eSPI::pushImage(int32_t x, int32_t y, int32_t w, int32_t h,
+                         const uint16_t *data) {
+  // Pixels go out low byte first unless swapped, and the panel reads the
+  // high byte first
+  std::vector<uint16_t> wire(data, data + w * h);
+  if (!_swapBytes) {
+    for (uint16_t &c : wire)
+      c = swap16(c);
+  }
+  writeRect(x, y, w, h, wire.data(), 0);
+}
+
+void TFT_eSPI::pushImage(int32_t x, int32_t y, int32_t w, int32_t h,
+                         uint8_t *data, bool) {
+  std::vector<uint16_t> colors((size_t)w * h);
+  for (size_t i = 0; i < colors.size(); i++)
+    colors[i] = standInColor8to16(data[i]);
+  writeRect(x, y, w, h, colors.data(), 0);
+}
+
+size_t TFT_eSPI::write(uint8_t c) {
+  if (c == '\n') {
+    _cursorX = 0;
+    _cursorY += 8 * _textSize;
+  } else if (c != '\r') {
+    drawChar(_cursorX, _cursorY, c, _textColor, _textBg, _textSize);
+    _cursorX += 6 * _textSize;
+  }
+  return 1;
+}
+
+uint16_t TFT_eSPI::readPixel(int32_t x, int32_t y) {
+  if (x < 0 || y < 0 || x >= _width || y >= _height || !ready())
+    return 0;
+  return loadPixel(y * _width + x);
+}
+
+bool TFT_eSPI::dumpPPM(const char *path) {
+  FILE *f = fopen(path, "wb");
+  if (!f)
+    return false;
+  fprintf(f, "P6\n%d %d\n255\n", _width, _height);
+  for (int32_t y = 0; y < _height; y++) {
+    for (int32_t x = 0; x < _width; x++) {
+      uint16_t c = readPixel(x, y);
+      // Expand 5/6/5 bits to 8 by repeating the top bits
+      uint8_t r = c >> 11, g = c >> 5 & 0x3F, b = c & 0x1F;
+      uint8_t rgb[3] = {(uint8_t)(r << 3 | r >> 2), (uint8_t)(g << 2 | g >> 4),
+                        (uint8_t)(b << 3 | b >> 2)};
+      fwrite(rgb, 1, sizeof(rgb), f);
+    }
+  }
+  return fclose(f) == 0;
+}
+
+// --- Sprites ---
+
+size_t TFT_eSprite::bytesAllocated = 0;
+
+void *TFT_eSprite::setColorDepth(int8_t depth) {
+  _depth = depth == 8 ? 8 : 16;
+  if (created()) {
+    // TFT_eSPI recreates the sprite at the new depth
+    int16_t w = _width, h = _height;
+    deleteSprite();
+    return createSprite(w, h);
+  }
+  return nullptr;
+}
+
+void *TFT_eSprite::createSprite(int16_t w, int16_t h, uint8_t) {
+  if (created())
+    return _mem.data();
+  _width = w;
+  _height = h;
+  _mem.assign((size_t)w * h * _depth / 8, 0); // black
+  bytesAllocated += _mem.size();
+  return _mem.data();
+}
+
+void TFT_eSprite::deleteSprite() {
+  if (!created())
+    return;
+  bytesAllocated -= _mem.size();
+  _mem.clear();
+  _width = 0;
+  _height = 0;
+}
+
+void TFT_eSprite::storePixel(size_t i, uint16_t color) {
+  if (_depth == 8) {
+    _mem[i] = standInColor16to8(color);
+  } else {
+    _mem[2 * i] = color >> 8;
+    _mem[2 * i + 1] = color;
+  }
+}
+
+uint16_t TFT_eSprite::loadPixel(size_t i) {
+  if (_depth == 8)
+    return standInColor8to16(_mem[i]);
+  return _mem[2 * i] << 8 | _mem[2 * i + 1];
+}
+
+// One window on the panel, read back from the sprite's RAM
+void TFT_eSprite::pushRect(int32_t tx, int32_t ty, int32_t sx, int32_t sy,
+                           int32_t sw, int32_t sh) {
+  std::vector<uint16_t> rect((size_t)sw * sh);
+  for (int32_t y = 0; y < sh; y++) {
+    for (int32_t x = 0; x < sw; x++)
+      rect[y * sw + x] = loadPixel((sy + y) * _width + sx + x);
+  }
+  _tft->writeRect(tx, ty, sw, sh, rect.data(), 0);
+}
+
+void TFT_eSprite::pushSprite(int32_t x, int32_t y) {
+  if (created())
+    pushRect(x, y, 0, 0, _width, _height);
+}
+
+bool TFT_eSprite::pushSprite(int32_t tx, int32_t ty, int32_t sx, int32_t sy,
+                             int32_t sw, int32_t sh) {
+  // The source rectangle is clipped to the sprite first
+  if (!created())
+    return false;
+  if (sx < 0) {
+    sw += sx;
+    tx -= sx;
+    sx = 0;
+  }
+  if (sy < 0) {
+    sh += sy;
+    ty -= sy;
+    sy = 0;
+  }
+  sw = min<int32_t>(sw, _width - sx);
+  sh = min<int32_t>(sh, _height - sy);
+  if (sw <= 0 || sh <= 0)
+    return false;
+  // Like TFT_eSPI: a block copy only when whole sprite rows go out, else
+  // a pushImage() and so a window per row
+  if (sx == 0 && sw == _width) {
+    pushRect(tx, ty, sx, sy, sw, sh);
+  } else {
+    for (int32_t y = 0; y < sh; y++)
+      pushRect(tx, ty + y, sx, sy + y, sw, 1);
+  }
+  return true;
+}
+
+void TFT_eSprite::pushImage(int32_t x, int32_t y, int32_t w, int32_t h,
+                            const uint16_t *data) {
+  // 8-bit sprites convert the colour by value; 16-bit ones keep the bytes
+  // as they are and push them high byte first, so unswapped data comes out
+  // byte-swapped just like on the panel
+  std::vector<uint16_t> colors(data, data + w * h);
+  if (_depth == 16 && !_swapBytes) {
+    for (uint16_t &c : colors)
+      c = swap16(c);
+  } else if (_depth == 8 && _swapBytes) {
+    for (uint16_t &c : colors)
+      c = swap16(c);
+  }
+  writeRect(x, y, w, h, colors.data(), 0);
+}
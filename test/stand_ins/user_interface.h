@@ -0,0 +1,7 @@
+#ifndef STAND_IN_USER_INTERFACE_H
+#define STAND_IN_USER_INTERFACE_H
+
+// rst_info and the REASON_* codes live in the Arduino.h stand-in
+#include <Arduino.h>
+
+#endif
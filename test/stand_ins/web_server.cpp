@@ -0,0 +1,79 @@
+#include <ESP8266WebServer.h>
+
+String ESP8266WebServer::arg(const String &name) {
+  auto it = requestArgs.find(name.c_str());
+  return it == requestArgs.end() ? String() : String(it->second);
+}
+
+String ESP8266WebServer::header(const String &name) {
+  auto it = requestHeaders.find(name.c_str());
+  return it == requestHeaders.end() ? String() : String(it->second);
+}
+
+void ESP8266WebServer::send(int code, const char *type,
+                            const String &content) {
+  status = code;
+  contentType = type ? type : "";
+  chunked = _contentLength == CONTENT_LENGTH_UNKNOWN;
+  _contentLength = CONTENT_LENGTH_NOT_SET;
+  body.assign(content.c_str(), content.length());
+}
+
+void ESP8266WebServer::send_P(int code, PGM_P type, PGM_P content,
+                              size_t len) {
+  send(code, type);
+  chunked = false;
+  body.assign(content, len);
+}
+
+void ESP8266WebServer::sendHeader(const String &name, const String &value,
+                                  bool first) {
+  auto header = std::make_pair(std::string(name.c_str()),
+                               std::string(value.c_str()));
+  if (first)
+    sentHeaders.insert(sentHeaders.begin(), header);
+  else
+    sentHeaders.push_back(header);
+}
+
+void ESP8266WebServer::sendContent(const char *content, size_t len) {
+  if (chunked && !len)
+    finished = true;
+  body.append(content, len);
+}
+
+std::string ESP8266WebServer::sentHeader(const char *name) const {
+  for (const auto &header : sentHeaders) {
+    if (strcasecmp(header.first.c_str(), name) == 0)
+      return header.second;
+  }
+  return std::string();
+}
+
+bool ESP8266WebServer::request(const char *uri, HTTPMethod method) {
+  status = 0;
+  contentType.clear();
+  sentHeaders.clear();
+  body.clear();
+  chunked = false;
+  finished = false;
+  _contentLength = CONTENT_LENGTH_NOT_SET;
+  _uri = uri;
+  requestMethod = method;
+  // The core parses the args into Strings that live until the next request
+  _currentArgs.clear();
+  for (const auto &arg : requestArgs) {
+    _currentArgs.push_back(String(arg.first));
+    _currentArgs.push_back(String(arg.second));
+  }
+  for (const Route &route : _routes) {
+    if (route.uri == uri &&
+        (route.method == HTTP_ANY || route.method == method)) {
+      route.handler();
+      return true;
+    }
+  }
+  if (_notFound)
+    _notFound();
+  return false;
+}
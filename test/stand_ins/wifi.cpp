@@ -0,0 +1,157 @@
+#include <ESP8266WiFi.h>
+
+#include <map>
+
+ESP8266WiFiClass WiFi;
+
+static std::map<std::string, StandInHost *> &hosts() {
+  static std::map<std::string, StandInHost *> map;
+  return map;
+}
+
+static unsigned long connects = 0;
+
+static std::string hostKey(const char *host, uint16_t port) {
+  return std::string(host) + ":" + std::to_string(port);
+}
+
+void standInListen(const char *host, uint16_t port, StandInHost *peer) {
+  if (peer)
+    hosts()[hostKey(host, port)] = peer;
+  else
+    hosts().erase(hostKey(host, port));
+}
+
+unsigned long standInConnects() { return connects; }
+
+// --- Sockets ---
+
+void StandInSocket::send(const char *data, size_t len, unsigned long delayMs) {
+  if (len)
+    rx.push_back({std::string(data, len), millis() + delayMs});
+}
+
+size_t StandInSocket::visible() const {
+  size_t n = 0;
+  unsigned long now = millis();
+  for (const StandInSegment &s : rx) {
+    if ((long)(now - s.at) < 0)
+      break; // in order: later segments are not there yet either
+    n += s.data.size();
+  }
+  return rx.empty() ? 0 : n - rxOffset;
+}
+
+int WiFiClient::connect(const char *host, uint16_t port) {
+  stop();
+  auto it = hosts().find(hostKey(host, port));
+  if (it == hosts().end())
+    return 0;
+  auto socket = std::make_shared<StandInSocket>();
+  socket->host = it->second;
+  if (!socket->host->accept(*socket))
+    return 0;
+  _socket = socket;
+  connects++;
+  return 1;
+}
+
+uint8_t WiFiClient::connected() {
+  if (!_socket || !_socket->open)
+    return 0;
+  // Like the core: a closed connection still counts while data is left,
+  // and the peer's FIN only arrives after the data it sent
+  return _socket->peerOpen || !_socket->rx.empty();
+}
+
+void WiFiClient::stop() {
+  if (_socket)
+    _socket->open = false;
+  _socket.reset();
+}
+
+size_t WiFiClient::write(const uint8_t *buf, size_t n) {
+  if (!_socket || !_socket->open || !_socket->peerOpen)
+    return 0;
+  n = min(n, _socket->writeLimit);
+  _socket->tx.append((const char *)buf, n);
+  if (_socket->host)
+    _socket->host->receive(*_socket);
+  return n;
+}
+
+int WiFiClient::available() { return _socket ? _socket->visible() : 0; }
+
+int WiFiClient::read() {
+  if (!available())
+    return -1;
+  uint8_t c = _socket->rx.front().data[_socket->rxOffset];
+  peekConsume(1);
+  return c;
+}
+
+int WiFiClient::read(uint8_t *buf, size_t n) {
+  size_t count = 0;
+  while (count < n && available()) {
+    size_t chunk = min(n - count, peekAvailable());
+    memcpy(buf + count, peekBuffer(), chunk);
+    peekConsume(chunk);
+    count += chunk;
+  }
+  return count;
+}
+
+int WiFiClient::peek() {
+  return available() ? (uint8_t)_socket->rx.front().data[_socket->rxOffset]
+                     : -1;
+}
+
+size_t WiFiClient::peekAvailable() {
+  if (!available())
+    return 0;
+  return _socket->rx.front().data.size() - _socket->rxOffset;
+}
+
+const char *WiFiClient::peekBuffer() {
+  return available() ? _socket->rx.front().data.data() + _socket->rxOffset
+                     : nullptr;
+}
+
+void WiFiClient::peekConsume(size_t n) {
+  while (n && available()) {
+    size_t chunk = min(n, peekAvailable());
+    _socket->rxOffset += chunk;
+    n -= chunk;
+    if (_socket->rxOffset == _socket->rx.front().data.size()) {
+      _socket->rx.pop_front();
+      _socket->rxOffset = 0;
+    }
+  }
+}
+
+// --- WiFi ---
+
+int ESP8266WiFiClass::begin(const char *ssid, const char *, int32_t,
+                            const uint8_t *, bool) {
+  _ssid = ssid;
+  _status = joinResult;
+  return _status;
+}
+
+bool ESP8266WiFiClass::disconnect(bool) {
+  _status = WL_DISCONNECTED;
+  return true;
+}
+
+uint8_t *ESP8266WiFiClass::macAddress(uint8_t *mac) {
+  static const uint8_t address[6] = {0x5C, 0xCF, 0x7F, 0x00, 0x00, 0x01};
+  memcpy(mac, address, sizeof(address));
+  return mac;
+}
+
+int8_t ESP8266WiFiClass::scanNetworks(bool async, bool) {
+  _scanState = (int8_t)scanResults.size();
+  return async ? WIFI_SCAN_RUNNING : _scanState;
+}
+
+int8_t ESP8266WiFiClass::scanComplete() { return _scanState; }
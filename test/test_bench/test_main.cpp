@@ -0,0 +1,230 @@
+// Host benchmarks of the pure-logic hot paths, run with `pio test -e native`.
+// Each case reports ns/op and heap allocations per op; the cases that are
+// meant to run without touching the heap also assert it.
+
+#include <Arduino.h>
+#include <LittleFS.h>
+#include <unity.h>
+
+#include <chrono>
+#include <new>
+
+#include "config_store.h"
+#include "display_utils.h"
+#include "fake_transmission.h"
+#include "http_response_parser.h"
+#include "settings.h"
+#include "speed_monitor.h"
+#include "transmission_client.h"
+
+#define HOST_BENCH_MS 200 // per case
+
+// --- Allocation Counter ---
+// Host allocations through operator new, plus String data on the modelled
+// ESP heap
+
+static unsigned long allocations = 0;
+
+void *operator new(size_t size) {
+  allocations++;
+  if (void *p = malloc(size ? size : 1))
+    return p;
+  throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept { free(p); }
+void operator delete(void *p, size_t) noexcept { free(p); }
+
+// --- Runner ---
+
+typedef void (*BenchFn)(uint32_t i);
+
+struct BenchResult {
+  uint32_t ops;
+  double nsPerOp;
+  double allocsPerOp;
+};
+
+static volatile uint32_t sink;
+
+static BenchResult run(const char *name, BenchFn fn) {
+  using namespace std::chrono;
+  fn(0); // warm up lazy statics
+
+  BenchResult r = {0, 0, 0};
+  unsigned long allocsBefore = allocations + standInHeapAllocs();
+  steady_clock::time_point start = steady_clock::now();
+  steady_clock::duration elapsed;
+  do {
+    fn(r.ops++);
+    elapsed = steady_clock::now() - start;
+  } while (elapsed < milliseconds(HOST_BENCH_MS));
+
+  r.nsPerOp = (double)duration_cast<nanoseconds>(elapsed).count() / r.ops;
+  r.allocsPerOp =
+      (double)(allocations + standInHeapAllocs() - allocsBefore) / r.ops;
+  printf("%-24s %10lu ops %10.1f ns/op %6.2f allocs/op\n", name,
+         (unsigned long)r.ops, r.nsPerOp, r.allocsPerOp);
+  return r;
+}
+
+// --- Fixtures ---
+
+static const char credentials[] = "transmission:correct horse battery";
+
+static const char handshakeResponse[] =
+    "HTTP/1.1 409 Conflict\r\n"
+    "Server: Transmission\r\n"
+    "X-Transmission-Session-Id: "
+    "fB7Yq2ZfS1kC0xQeP4Jm8vW3tR6uN9hL5aD2gE1iO0yTzXcV\r\n"
+    "Date: Sat, 17 Oct 2026 12:00:00 GMT\r\n"
+    "Content-Length: 612\r\n"
+    "Content-Type: text/html; charset=ISO-8859-1\r\n"
+    "\r\n";
+
+static const char chunkedBody[] =
+    "48\r\n"
+    "{\"arguments\":{\"activeTorrentCount\":3,\"downloadSpeed\":1843200,"
+    "\"pausedTorr\r\n"
+    "46\r\n"
+    "entCount\":1,\"torrentCount\":4,\"uploadSpeed\":524288},\"result\":"
+    "\"success\"}\r\n"
+    "0\r\n\r\n";
+
+static const char statsBody[] =
+    "{\"arguments\":{\"activeTorrentCount\":3,\"cumulative-stats\":"
+    "{\"downloadedBytes\":912837123,\"filesAdded\":120,\"secondsActive\":"
+    "8812733,\"sessionCount\":42,\"uploadedBytes\":2038172312},"
+    "\"downloadSpeed\":1843200,\"pausedTorrentCount\":1,\"torrentCount\":4,"
+    "\"uploadSpeed\":524288},\"result\":\"success\"}";
+
+static TransmissionSettings rpcTarget() {
+  TransmissionSettings t = {};
+  t.port = 9091;
+  t.poll = SETTINGS_DEFAULT_POLL;
+  strcpy(t.host, "192.168.1.2");
+  strcpy(t.path, SETTINGS_DEFAULT_PATH);
+  strcpy(t.user, "transmission");
+  strcpy(t.pass, "correct horse battery");
+  return t;
+}
+
+// --- Cases ---
+
+static void benchBase64(uint32_t) {
+  char out[64];
+  sink = base64Encode(credentials, sizeof(credentials) - 1, out, sizeof(out));
+}
+
+static void benchConfigLoad(uint32_t) {
+  static Settings loaded;
+  sink = configStoreLoad(loaded);
+}
+
+static void benchConfigSaveUnchanged(uint32_t) {
+  sink = configStoreSave(settings); // CRC match: nothing is written
+}
+
+static void benchHttpHeaders(uint32_t) {
+  HttpResponseParser parser;
+  parser.reset();
+  sink = parser.feed(handshakeResponse, sizeof(handshakeResponse) - 1) +
+         parser.status();
+}
+
+static void benchChunked(uint32_t) {
+  HttpChunkDecoder chunks;
+  chunks.reset();
+  uint32_t data = 0;
+  for (const char *p = chunkedBody; *p; p++)
+    data += chunks.feed(*p);
+  sink = data;
+}
+
+static StaticJsonDocument<96> statsFilter;
+
+static void benchStatsJson(uint32_t) {
+  const JsonDocument &filter = statsFilter;
+  StaticJsonDocument<SPEED_STATS_DOC_SIZE> doc;
+  deserializeJson(doc, statsBody, sizeof(statsBody) - 1,
+                  DeserializationOption::Filter(filter));
+  sink = doc["arguments"]["downloadSpeed"] | 0UL;
+}
+
+static TransmissionClient rpcClient;
+static StaticJsonDocument<SPEED_STATS_DOC_SIZE> rpcResult;
+
+static void benchRpcRoundTrip(uint32_t) {
+  rpcClient.start("{\"method\":\"session-stats\"}", rpcResult, &statsFilter);
+  while (!rpcClient.finished())
+    rpcClient.poll();
+  sink = rpcClient.state();
+}
+
+static void benchStatusBarDiff(uint32_t i) {
+  static const IPAddress ip(192, 168, 1, 50);
+  StatusBarView prev =
+      statusBarView(STATE_CONNECTED, -55 - (long)(i % 40), false, ip);
+  StatusBarView next =
+      statusBarView(STATE_CONNECTED, -55 - (long)((i + 1) % 40), false, ip);
+  StatusWindow win;
+  sink = statusBarDiff(prev, next, win);
+}
+
+// --- Tests ---
+
+void setUp() {}
+
+void tearDown() {}
+
+static void test_base64() {
+  TEST_ASSERT_EQUAL(0, run("base64", benchBase64).allocsPerOp);
+}
+
+static void test_config_store() {
+  LittleFS.format();
+  settingsDefaults(settings);
+  strcpy(settings.trans.host, "192.168.1.2");
+  TEST_ASSERT_TRUE(configStoreSave(settings));
+  run("config_load", benchConfigLoad);
+
+  unsigned long written = LittleFS.bytesWritten;
+  BenchResult r = run("config_save_unchanged", benchConfigSaveUnchanged);
+  TEST_ASSERT_EQUAL(0, r.allocsPerOp);
+  TEST_ASSERT_EQUAL(written, LittleFS.bytesWritten);
+}
+
+static void test_http_parsing() {
+  TEST_ASSERT_EQUAL(0, run("http_headers", benchHttpHeaders).allocsPerOp);
+  TEST_ASSERT_EQUAL(0, run("http_chunked", benchChunked).allocsPerOp);
+}
+
+static void test_rpc() {
+  statsFilter["arguments"]["downloadSpeed"] = true;
+  statsFilter["arguments"]["uploadSpeed"] = true;
+  run("rpc_stats_json", benchStatsJson);
+
+  FakeTransmission server;
+  rpcClient.configure(rpcTarget());
+  run("rpc_round_trip", benchRpcRoundTrip);
+  TEST_ASSERT_EQUAL(RPC_DONE, rpcClient.state());
+  // The session id and the socket are reused for every request after the
+  // first one
+  TEST_ASSERT_EQUAL(1, server.handshakes);
+  TEST_ASSERT_EQUAL(1, rpcClient.reconnects());
+  rpcClient.reset();
+}
+
+static void test_status_bar_diff() {
+  TEST_ASSERT_EQUAL(0, run("status_bar_diff", benchStatusBarDiff).allocsPerOp);
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_base64);
+  RUN_TEST(test_config_store);
+  RUN_TEST(test_http_parsing);
+  RUN_TEST(test_rpc);
+  RUN_TEST(test_status_bar_diff);
+  return UNITY_END();
+}
@@ -0,0 +1,203 @@
+// The binary config store on the in-memory LittleFS: round trips, skipped
+// writes, power cuts at every byte of a save, recovery from the temp file,
+// and byte-stable records however the settings were edited.
+
+#include <Arduino.h>
+#include <ESP8266WebServer.h>
+#include <LittleFS.h>
+#include <coredecls.h>
+#include <unity.h>
+
+#include <string>
+
+#include "config_store.h"
+#include "settings.h"
+
+#define RECORD_HEADER 12 // magic, version, size, CRC
+
+static Settings oldSettings;
+static Settings newSettings;
+
+static bool sameSettings(const Settings &a, const Settings &b) {
+  return memcmp(&a, &b, sizeof(Settings)) == 0;
+}
+
+// Every byte behind the NUL of a text field must be zero
+static bool zeroTail(const char *field, size_t size) {
+  for (size_t i = strlen(field); i < size; i++) {
+    if (field[i])
+      return false;
+  }
+  return true;
+}
+
+// A fresh boot: nothing cached, the record is read back from flash
+static bool reboot(Settings &s) {
+  LittleFS.powerRestore();
+  memset(&s, 0xA5, sizeof(s));
+  return configStoreLoad(s);
+}
+
+void setUp() {
+  LittleFS.format();
+  configStoreErase();
+
+  settingsDefaults(oldSettings);
+  settingsCopyText(oldSettings.trans.host, "192.168.1.2",
+                   sizeof(oldSettings.trans.host));
+  newSettings = oldSettings;
+  settingsCopyText(newSettings.trans.host, "nas.local",
+                   sizeof(newSettings.trans.host));
+  newSettings.trans.poll = 5;
+}
+
+void tearDown() {}
+
+// --- Saving ---
+
+static void test_round_trip() {
+  TEST_ASSERT_TRUE(configStoreSave(oldSettings));
+  TEST_ASSERT_EQUAL(RECORD_HEADER + sizeof(Settings),
+                    LittleFS.files[CONFIG_STORE_FILE].size());
+  TEST_ASSERT_EQUAL(0, LittleFS.files.count(CONFIG_STORE_TMP));
+
+  Settings loaded;
+  TEST_ASSERT_TRUE(reboot(loaded));
+  TEST_ASSERT_TRUE(sameSettings(oldSettings, loaded));
+}
+
+static void test_unchanged_save_writes_nothing() {
+  TEST_ASSERT_TRUE(configStoreSave(oldSettings));
+  unsigned long written = LittleFS.bytesWritten;
+  TEST_ASSERT_TRUE(configStoreSave(oldSettings));
+  TEST_ASSERT_EQUAL(written, LittleFS.bytesWritten);
+
+  // After a reboot too: the CRC of the loaded record is remembered
+  Settings loaded;
+  TEST_ASSERT_TRUE(reboot(loaded));
+  TEST_ASSERT_TRUE(configStoreSave(loaded));
+  TEST_ASSERT_EQUAL(written, LittleFS.bytesWritten);
+}
+
+// --- Power Loss ---
+
+static void test_power_cut_at_every_byte_keeps_a_whole_record() {
+  const size_t record = RECORD_HEADER + sizeof(Settings);
+  for (size_t cut = 0; cut <= record; cut++) {
+    setUp();
+    TEST_ASSERT_TRUE(configStoreSave(oldSettings));
+
+    LittleFS.powerCut(cut);
+    bool saved = configStoreSave(newSettings);
+
+    Settings loaded;
+    TEST_ASSERT_TRUE(reboot(loaded));
+    if (saved) {
+      TEST_ASSERT_TRUE(sameSettings(newSettings, loaded));
+    } else {
+      // Either record is fine, a mix of the two never is
+      TEST_ASSERT_TRUE(sameSettings(oldSettings, loaded) ||
+                       sameSettings(newSettings, loaded));
+    }
+  }
+}
+
+static void test_recovers_from_the_temp_file() {
+  // Power lost between closing the temp file and the rename, with the old
+  // record already gone
+  TEST_ASSERT_TRUE(configStoreSave(newSettings));
+  LittleFS.rename(CONFIG_STORE_FILE, CONFIG_STORE_TMP);
+
+  Settings loaded;
+  TEST_ASSERT_TRUE(reboot(loaded));
+  TEST_ASSERT_TRUE(sameSettings(newSettings, loaded));
+  TEST_ASSERT_EQUAL(1, LittleFS.files.count(CONFIG_STORE_FILE));
+  TEST_ASSERT_EQUAL(0, LittleFS.files.count(CONFIG_STORE_TMP));
+}
+
+static void test_rejects_a_torn_record() {
+  TEST_ASSERT_TRUE(configStoreSave(newSettings));
+  std::string &data = LittleFS.files[CONFIG_STORE_FILE];
+
+  // Cut short
+  std::string whole = data;
+  data.resize(whole.size() / 2);
+  Settings loaded;
+  TEST_ASSERT_FALSE(reboot(loaded));
+
+  // Whole length, but a stale byte in the middle
+  data = whole;
+  data[RECORD_HEADER + 40] ^= 0x5A;
+  TEST_ASSERT_FALSE(reboot(loaded));
+
+  // A torn main record next to a good temp file: the temp file wins
+  LittleFS.files[CONFIG_STORE_TMP] = whole;
+  TEST_ASSERT_TRUE(reboot(loaded));
+  TEST_ASSERT_TRUE(sameSettings(newSettings, loaded));
+}
+
+// --- Stable Records ---
+
+static void test_shorter_value_leaves_no_stale_tail() {
+  ESP8266WebServer server;
+  Settings edited = oldSettings;
+
+  server.requestArgs["host"] = "transmission.example.internal";
+  server.requestArgs["user"] = "a-rather-long-user-name";
+  TEST_ASSERT_NULL(settingsParseTransmission(edited.trans, server));
+  server.requestArgs["host"] = "nas.local";
+  server.requestArgs["user"] = "";
+  server.requestArgs["poll"] = "5";
+  TEST_ASSERT_NULL(settingsParseTransmission(edited.trans, server));
+
+  TEST_ASSERT_TRUE(zeroTail(edited.trans.host, sizeof(edited.trans.host)));
+  TEST_ASSERT_TRUE(zeroTail(edited.trans.user, sizeof(edited.trans.user)));
+  // The same settings give the same bytes, and so the same CRC
+  TEST_ASSERT_TRUE(sameSettings(newSettings, edited));
+  TEST_ASSERT_EQUAL_HEX32(crc32(&newSettings, sizeof(Settings)),
+                          crc32(&edited, sizeof(Settings)));
+
+  // Nothing new to write for settings that are already on flash
+  TEST_ASSERT_TRUE(configStoreSave(newSettings));
+  unsigned long written = LittleFS.bytesWritten;
+  TEST_ASSERT_TRUE(configStoreSave(edited));
+  TEST_ASSERT_EQUAL(written, LittleFS.bytesWritten);
+}
+
+static void test_network_over_a_longer_one_leaves_no_stale_tail() {
+  settingsDefaults(settings);
+  TEST_ASSERT_NULL(settingsAddNetwork("a-long-network-name", "password-1234"));
+  TEST_ASSERT_NULL(settingsAddNetwork("home", ""));
+  TEST_ASSERT_EQUAL_STRING("home", settings.networks[0].ssid);
+  TEST_ASSERT_TRUE(zeroTail(settings.networks[0].ssid, SETTINGS_SSID_LEN));
+  TEST_ASSERT_TRUE(zeroTail(settings.networks[0].pass, SETTINGS_PASS_LEN));
+  TEST_ASSERT_EQUAL_STRING("a-long-network-name", settings.networks[1].ssid);
+}
+
+static void test_legacy_network_is_stored_without_the_rules() {
+  settingsDefaults(settings);
+  // A password saved before the 8-64 character rule
+  TEST_ASSERT_NOT_NULL(settingsAddNetwork("cabin", "wep40"));
+  TEST_ASSERT_EQUAL(0, settings.networkCount);
+  TEST_ASSERT_TRUE(settingsStoreNetwork("cabin", "wep40"));
+  TEST_ASSERT_EQUAL(1, settings.networkCount);
+  TEST_ASSERT_EQUAL_STRING("cabin", settings.networks[0].ssid);
+  TEST_ASSERT_EQUAL_STRING("wep40", settings.networks[0].pass);
+  TEST_ASSERT_TRUE(zeroTail(settings.networks[0].pass, SETTINGS_PASS_LEN));
+
+  TEST_ASSERT_FALSE(settingsStoreNetwork("", "password-1234"));
+  TEST_ASSERT_EQUAL(1, settings.networkCount);
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_round_trip);
+  RUN_TEST(test_unchanged_save_writes_nothing);
+  RUN_TEST(test_power_cut_at_every_byte_keeps_a_whole_record);
+  RUN_TEST(test_recovers_from_the_temp_file);
+  RUN_TEST(test_rejects_a_torn_record);
+  RUN_TEST(test_shorter_value_leaves_no_stale_tail);
+  RUN_TEST(test_network_over_a_longer_one_leaves_no_stale_tail);
+  RUN_TEST(test_legacy_network_is_stored_without_the_rules);
+  return UNITY_END();
+}
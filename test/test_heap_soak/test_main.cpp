@@ -0,0 +1,255 @@
+// A day of uptime on the modelled ESP heap. The speed monitor polls the
+// fake daemon every 2 s while the settings page is used through the day:
+// the params are read and a connection is tested with form values every
+// 10 minutes, and new params are saved every 2 hours. The day runs once
+// with the Settings struct and once with the String globals it replaced
+// in 0.4.4, reporting ESP.getHeapFragmentation() before and after each.
+
+#include <Arduino.h>
+#include <ESP8266WebServer.h>
+#include <unity.h>
+
+#include "fake_transmission.h"
+#include "settings.h"
+#include "speed_monitor.h"
+
+#define SOAK_HOURS 24
+#define SOAK_PASS_MS 100             // one loop() pass
+#define SOAK_PAGE_MS (10 * 60000UL)  // settings page opened
+#define SOAK_SAVE_MS (2 * 3600000UL) // params saved
+
+struct HeapState {
+  uint32_t free;
+  uint32_t maxBlock;
+  uint8_t fragmentation;
+};
+
+static HeapState heapState() {
+  return {ESP.getFreeHeap(), ESP.getMaxFreeBlockSize(),
+          ESP.getHeapFragmentation()};
+}
+
+static void report(const char *run, const HeapState &before,
+                   const HeapState &after, uint8_t worst) {
+  printf("%-8s before: %5u free %5u max block %3u%% fragmented | "
+         "after %dh: %5u free %5u max block %3u%% fragmented, "
+         "worst %u%%\n",
+         run, (unsigned)before.free, (unsigned)before.maxBlock,
+         before.fragmentation, SOAK_HOURS, (unsigned)after.free,
+         (unsigned)after.maxBlock, after.fragmentation, worst);
+}
+
+// --- Form Values ---
+
+static const char *const testHosts[] = {"192.168.1.2", "nas.local",
+                                        "transmission.home.arpa",
+                                        "seedbox.example.net"};
+static const char *const users[] = {"transmission", "admin"};
+static const char *const passwords[] = {"correct horse battery",
+                                        "hunter2hunter2"};
+
+static void setForm(ESP8266WebServer &server, const char *host, int i) {
+  server.requestArgs.clear();
+  server.requestArgs["host"] = host;
+  server.requestArgs["port"] = "9091";
+  server.requestArgs["path"] = SETTINGS_DEFAULT_PATH;
+  server.requestArgs["user"] = users[i % 2];
+  server.requestArgs["pass"] = passwords[i % 2];
+  server.requestArgs["poll"] = "2";
+}
+
+// The params as JSON, the same response String for both runs
+static void sendParams(ESP8266WebServer &server, const char *host, int port,
+                       const char *path, const char *user, const char *pass,
+                       int poll) {
+  String json = String("{\"host\":\"") + host + "\",\"port\":" + port +
+                ",\"path\":\"" + path + "\",\"user\":\"" + user +
+                "\",\"pass\":\"" + pass + "\",\"poll\":" + poll + "}";
+  server.send(200, "application/json", json);
+}
+
+// --- Settings Struct (0.4.4) ---
+// The handlers in main.cpp, minus the flash write and the RPC itself
+
+static TransmissionSettings testTarget;
+
+static void routesForStruct(ESP8266WebServer &server) {
+  server.on("/params", HTTP_GET, [&server] {
+    const TransmissionSettings &t = settings.trans;
+    sendParams(server, t.host, t.port, t.path, t.user, t.pass, t.poll);
+  });
+  server.on("/params", HTTP_POST, [&server] {
+    const char *error = settingsParseTransmission(settings.trans, server);
+    if (error) {
+      server.send(400, "text/plain", error);
+      return;
+    }
+    speedMonitorConfigure(settings.trans);
+    server.send(200, "text/plain", "Params saved!");
+  });
+  server.on("/test", HTTP_POST, [&server] {
+    TransmissionSettings target = settings.trans;
+    const char *error = settingsParseTransmission(target, server);
+    if (error || !target.host[0]) {
+      server.send(400, "text/plain", error ? error : "Host invalid");
+      return;
+    }
+    testTarget = target;
+    server.send(202, "text/plain", "Testing...");
+  });
+}
+
+// --- String Globals (0.4.3) ---
+// The same handlers as they were: config in String globals, copied into
+// String locals per request and into the String members of the clients
+
+struct LegacyClient {
+  String host, path, user, pass;
+  int port = 0;
+
+  void configure(const String &h, int p, const String &pa, const String &u,
+                 const String &pw) {
+    host = h;
+    port = p;
+    path = pa;
+    user = u;
+    pass = pw;
+  }
+};
+
+struct LegacyConfig {
+  String transHost, transPath, transUser, transPass;
+  int transPort = SETTINGS_DEFAULT_PORT;
+  int transPoll = SETTINGS_DEFAULT_POLL;
+  LegacyClient monitorClient, testClient;
+};
+
+static void routesForStrings(ESP8266WebServer &server, LegacyConfig &c) {
+  server.on("/params", HTTP_GET, [&server, &c] {
+    sendParams(server, c.transHost.c_str(), c.transPort, c.transPath.c_str(),
+               c.transUser.c_str(), c.transPass.c_str(), c.transPoll);
+  });
+  server.on("/params", HTTP_POST, [&server, &c] {
+    c.transHost = server.arg("host");
+    c.transPort = server.arg("port").toInt();
+    c.transPath = server.arg("path");
+    c.transUser = server.arg("user");
+    c.transPass = server.arg("pass");
+    if (server.hasArg("poll"))
+      c.transPoll = server.arg("poll").toInt();
+    c.monitorClient.configure(c.transHost, c.transPort, c.transPath,
+                              c.transUser, c.transPass);
+    server.send(200, "text/plain", "Params saved!");
+  });
+  server.on("/test", HTTP_POST, [&server, &c] {
+    String host = c.transHost;
+    int port = c.transPort;
+    String path = c.transPath;
+    String user = c.transUser;
+    String pass = c.transPass;
+    if (server.hasArg("host"))
+      host = server.arg("host");
+    if (server.hasArg("port"))
+      port = server.arg("port").toInt();
+    if (server.hasArg("path"))
+      path = server.arg("path");
+    if (server.hasArg("user"))
+      user = server.arg("user");
+    if (server.hasArg("pass"))
+      pass = server.arg("pass");
+    if (host == "") {
+      server.send(400, "text/plain", "Host invalid");
+      return;
+    }
+    c.testClient.configure(host, port, path, user, pass);
+    server.send(202, "text/plain", "Testing...");
+  });
+}
+
+// --- Soak ---
+
+// Returns the worst fragmentation seen between requests
+static uint8_t soak(ESP8266WebServer &server) {
+  FakeTransmission daemon;
+  unsigned long samples = speedSampleCount();
+  unsigned long page = 0, saves = 0;
+  uint8_t worst = 0;
+
+  for (unsigned long ms = 0; ms < SOAK_HOURS * 3600000UL;
+       ms += SOAK_PASS_MS) {
+    speedMonitorLoop();
+    if (ms % SOAK_PAGE_MS == 0) {
+      TEST_ASSERT_TRUE(server.request("/params", HTTP_GET));
+      setForm(server, testHosts[page % 4], page);
+      TEST_ASSERT_TRUE(server.request("/test", HTTP_POST));
+      TEST_ASSERT_EQUAL(202, server.status);
+      page++;
+    }
+    if (ms % SOAK_SAVE_MS == 0) {
+      setForm(server, "192.168.1.2", saves++);
+      TEST_ASSERT_TRUE(server.request("/params", HTTP_POST));
+      TEST_ASSERT_EQUAL(200, server.status);
+    }
+    if (ms % SOAK_PAGE_MS == 0)
+      worst = max(worst, ESP.getHeapFragmentation());
+    standInAdvance(SOAK_PASS_MS);
+  }
+  server.requestArgs.clear();
+  server.request("/none"); // frees the last request's args
+
+  // A sample every 2 s, all day
+  TEST_ASSERT_UINT32_WITHIN(10, SOAK_HOURS * 1800UL,
+                            speedSampleCount() - samples);
+  return worst;
+}
+
+static void bootStruct() {
+  settingsDefaults(settings);
+  settingsCopyText(settings.trans.host, "192.168.1.2",
+                   sizeof(settings.trans.host));
+  speedMonitorConfigure(settings.trans);
+}
+
+void setUp() {}
+
+void tearDown() {}
+
+static void test_settings_struct_leaves_the_heap_as_it_was() {
+  bootStruct();
+  ESP8266WebServer server;
+  routesForStruct(server);
+
+  HeapState before = heapState();
+  uint8_t worst = soak(server);
+  HeapState after = heapState();
+  report("struct", before, after, worst);
+
+  TEST_ASSERT_EQUAL(before.free, after.free);
+  TEST_ASSERT_EQUAL(before.maxBlock, after.maxBlock);
+  TEST_ASSERT_EQUAL(before.fragmentation, after.fragmentation);
+}
+
+static void test_string_globals_for_comparison() {
+  bootStruct(); // the monitor itself runs the same code in both
+  LegacyConfig config;
+  ESP8266WebServer server;
+  routesForStrings(server, config);
+
+  // Booted with the config loaded into the globals and the monitor client
+  setForm(server, "192.168.1.2", 0);
+  TEST_ASSERT_TRUE(server.request("/params", HTTP_POST));
+  server.requestArgs.clear();
+  server.request("/none");
+
+  HeapState before = heapState();
+  uint8_t worst = soak(server);
+  HeapState after = heapState();
+  report("strings", before, after, worst);
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_settings_struct_leaves_the_heap_as_it_was);
+  RUN_TEST(test_string_globals_for_comparison);
+  return UNITY_END();
+}
@@ -0,0 +1,262 @@
+// HttpResponseParser and HttpChunkDecoder on the host: the headers the RPC
+// client relies on, any split of the input, the bounds on status and
+// lengths, and a throughput figure for each feed size.
+
+#include <unity.h>
+
+#include <chrono>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+
+#include "http_response_parser.h"
+
+#define HOST_BENCH_MS 200 // per feed size
+
+static const char okResponse[] = "HTTP/1.1 200 OK\r\n"
+                                 "Server: Transmission\r\n"
+                                 "Content-Type: application/json\r\n"
+                                 "Content-Length: 76\r\n"
+                                 "\r\n";
+
+static const char handshakeResponse[] =
+    "HTTP/1.1 409 Conflict\r\n"
+    "Server: Transmission\r\n"
+    "X-Transmission-Session-Id: "
+    "fB7Yq2ZfS1kC0xQeP4Jm8vW3tR6uN9hL5aD2gE1iO0yTzXcV\r\n"
+    "Date: Sat, 17 Oct 2026 12:00:00 GMT\r\n"
+    "Content-Length: 612\r\n"
+    "Content-Type: text/html; charset=ISO-8859-1\r\n"
+    "\r\n";
+
+static HttpResponseParser parser;
+
+static size_t feed(const char *text) {
+  parser.reset();
+  return parser.feed(text, strlen(text));
+}
+
+// Feeds text in pieces of step bytes, the way it may come off the socket
+static void feedSplit(const char *text, size_t step) {
+  parser.reset();
+  size_t len = strlen(text);
+  for (size_t i = 0; i < len && !parser.done() && !parser.failed();
+       i += step) {
+    size_t n = len - i < step ? len - i : step;
+    parser.feed(text + i, n);
+  }
+}
+
+static void assertRejected(const char *text) {
+  feed(text);
+  TEST_ASSERT_TRUE_MESSAGE(parser.failed(), text);
+  TEST_ASSERT_FALSE(parser.done());
+}
+
+static std::string decode(HttpChunkDecoder &chunks, const char *body) {
+  std::string data;
+  for (const char *p = body; *p; p++) {
+    if (chunks.feed(*p))
+      data += *p;
+  }
+  return data;
+}
+
+void setUp() {}
+
+void tearDown() {}
+
+// --- Headers ---
+
+static void test_ok_with_content_length() {
+  TEST_ASSERT_EQUAL(strlen(okResponse), feed(okResponse));
+  TEST_ASSERT_TRUE(parser.done());
+  TEST_ASSERT_EQUAL(200, parser.status());
+  TEST_ASSERT_EQUAL(76, parser.contentLength());
+  TEST_ASSERT_FALSE(parser.chunked());
+  TEST_ASSERT_TRUE(parser.keepAlive()); // HTTP/1.1 default
+  TEST_ASSERT_EQUAL_STRING("", parser.sessionId());
+}
+
+static void test_handshake_carries_the_session_id() {
+  feed(handshakeResponse);
+  TEST_ASSERT_TRUE(parser.done());
+  TEST_ASSERT_EQUAL(409, parser.status());
+  TEST_ASSERT_EQUAL(612, parser.contentLength());
+  TEST_ASSERT_EQUAL_STRING("fB7Yq2ZfS1kC0xQeP4Jm8vW3tR6uN9hL5aD2gE1iO0yTzXcV",
+                           parser.sessionId());
+}
+
+static void test_stops_at_the_end_of_the_headers() {
+  std::string text = std::string(okResponse) + "{\"result\":\"success\"}";
+  parser.reset();
+  TEST_ASSERT_EQUAL(strlen(okResponse),
+                    parser.feed(text.c_str(), text.size()));
+  TEST_ASSERT_TRUE(parser.done());
+}
+
+static void test_any_split_gives_the_same_result() {
+  for (size_t step = 1; step <= sizeof(handshakeResponse); step++) {
+    feedSplit(handshakeResponse, step);
+    TEST_ASSERT_TRUE(parser.done());
+    TEST_ASSERT_EQUAL(409, parser.status());
+    TEST_ASSERT_EQUAL(612, parser.contentLength());
+    TEST_ASSERT_EQUAL(48, strlen(parser.sessionId()));
+  }
+}
+
+static void test_chunked_and_connection_close() {
+  feed("HTTP/1.1 200 OK\r\n"
+       "transfer-encoding: chunked\r\n"
+       "CONNECTION: close\r\n"
+       "\r\n");
+  TEST_ASSERT_TRUE(parser.done());
+  TEST_ASSERT_TRUE(parser.chunked());
+  TEST_ASSERT_FALSE(parser.keepAlive());
+  TEST_ASSERT_EQUAL(-1, parser.contentLength());
+}
+
+static void test_http10_closes_unless_kept_alive() {
+  feed("HTTP/1.0 200 OK\r\n\r\n");
+  TEST_ASSERT_TRUE(parser.done());
+  TEST_ASSERT_FALSE(parser.keepAlive());
+
+  feed("HTTP/1.0 200 OK\r\nConnection: keep-alive\r\n\r\n");
+  TEST_ASSERT_TRUE(parser.keepAlive());
+}
+
+static void test_bare_lf_line_endings() {
+  feed("HTTP/1.1 200 OK\nContent-Length: 5\n\n");
+  TEST_ASSERT_TRUE(parser.done());
+  TEST_ASSERT_EQUAL(5, parser.contentLength());
+}
+
+static void test_long_session_id_is_truncated() {
+  std::string id(100, 'x');
+  std::string text =
+      "HTTP/1.1 409 Conflict\r\nX-Transmission-Session-Id: " + id + "\r\n\r\n";
+  feed(text.c_str());
+  TEST_ASSERT_TRUE(parser.done());
+  TEST_ASSERT_EQUAL(HTTP_MAX_SESSION_ID - 1, strlen(parser.sessionId()));
+}
+
+static void test_content_length_bounds() {
+  feed("HTTP/1.1 200 OK\r\nContent-Length: 0\r\n\r\n");
+  TEST_ASSERT_EQUAL(0, parser.contentLength());
+
+  feed("HTTP/1.1 200 OK\r\nContent-Length: 16777216 \r\n\r\n");
+  TEST_ASSERT_TRUE(parser.done());
+  TEST_ASSERT_EQUAL(HTTP_MAX_CONTENT_LENGTH, parser.contentLength());
+}
+
+// --- Rejected ---
+
+static void test_rejects_a_status_that_is_not_three_digits() {
+  assertRejected("HTTP/1.1 2000 OK\r\n\r\n");
+  assertRejected("HTTP/1.1 20 OK\r\n\r\n");
+  assertRejected("HTTP/1.1 2x0 OK\r\n\r\n");
+  assertRejected("HTTP/1.1 99999999999999999999 OK\r\n\r\n");
+}
+
+static void test_rejects_a_bad_content_length() {
+  assertRejected("HTTP/1.1 200 OK\r\nContent-Length: 16777217\r\n\r\n");
+  assertRejected(
+      "HTTP/1.1 200 OK\r\nContent-Length: 99999999999999999999\r\n\r\n");
+  assertRejected("HTTP/1.1 200 OK\r\nContent-Length: -1\r\n\r\n");
+  assertRejected("HTTP/1.1 200 OK\r\nContent-Length: 12abc\r\n\r\n");
+  assertRejected("HTTP/1.1 200 OK\r\nContent-Length: 1 2\r\n\r\n");
+  assertRejected("HTTP/1.1 200 OK\r\nContent-Length:\r\n\r\n");
+}
+
+static void test_rejects_a_broken_status_line() {
+  assertRejected("HTTP/1.1.1.1.1.1.1.1 200 OK\r\n\r\n");
+  assertRejected("HTTP/1.1\r\n\r\n");
+  assertRejected("HTTP/1.1 200 OK\r\n\rX");
+}
+
+// --- Chunked Bodies ---
+
+static void test_chunks_are_unwrapped() {
+  HttpChunkDecoder chunks;
+  chunks.reset();
+  std::string data =
+      decode(chunks, "9\r\n{\"result\"\r\nB;ext=1\r\n:\"success\"}\r\n"
+                     "0\r\nX-Trailer: 1\r\n\r\n");
+  TEST_ASSERT_EQUAL_STRING("{\"result\":\"success\"}", data.c_str());
+  TEST_ASSERT_TRUE(chunks.done());
+  TEST_ASSERT_FALSE(chunks.failed());
+}
+
+static void test_chunk_framing_split_anywhere() {
+  // The decoder is byte by byte, so a body cut into pieces is the same body
+  const char *body = "3\r\nabc\r\n2\r\nde\r\n0\r\n\r\n";
+  HttpChunkDecoder chunks;
+  chunks.reset();
+  std::string data = decode(chunks, std::string(body, 5).c_str());
+  TEST_ASSERT_FALSE(chunks.done());
+  data += decode(chunks, body + 5);
+  TEST_ASSERT_EQUAL_STRING("abcde", data.c_str());
+  TEST_ASSERT_TRUE(chunks.done());
+}
+
+static void test_rejects_an_oversized_chunk() {
+  HttpChunkDecoder chunks;
+  chunks.reset();
+  TEST_ASSERT_EQUAL(0, decode(chunks, "1000001\r\nabc").size());
+  TEST_ASSERT_TRUE(chunks.failed());
+
+  chunks.reset();
+  decode(chunks, "fffffffffffffffffff\r\n");
+  TEST_ASSERT_TRUE(chunks.failed());
+
+  chunks.reset();
+  decode(chunks, "1000000\r\n");
+  TEST_ASSERT_FALSE(chunks.failed());
+  TEST_ASSERT_TRUE(chunks.inData());
+}
+
+// --- Throughput ---
+
+static void test_throughput() {
+  using namespace std::chrono;
+  const size_t len = sizeof(handshakeResponse) - 1;
+  const size_t steps[] = {1, 16, 128, len};
+
+  for (size_t step : steps) {
+    unsigned long responses = 0;
+    steady_clock::time_point start = steady_clock::now();
+    steady_clock::duration elapsed;
+    do {
+      feedSplit(handshakeResponse, step);
+      TEST_ASSERT_TRUE(parser.done());
+      responses++;
+      elapsed = steady_clock::now() - start;
+    } while (elapsed < milliseconds(HOST_BENCH_MS));
+
+    double seconds = duration<double>(elapsed).count();
+    printf("http_parser feed %3u B %10.1f MB/s %8.0f ns/response\n",
+           (unsigned)step, responses * len / seconds / 1e6,
+           seconds * 1e9 / responses);
+  }
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_ok_with_content_length);
+  RUN_TEST(test_handshake_carries_the_session_id);
+  RUN_TEST(test_stops_at_the_end_of_the_headers);
+  RUN_TEST(test_any_split_gives_the_same_result);
+  RUN_TEST(test_chunked_and_connection_close);
+  RUN_TEST(test_http10_closes_unless_kept_alive);
+  RUN_TEST(test_bare_lf_line_endings);
+  RUN_TEST(test_long_session_id_is_truncated);
+  RUN_TEST(test_content_length_bounds);
+  RUN_TEST(test_rejects_a_status_that_is_not_three_digits);
+  RUN_TEST(test_rejects_a_bad_content_length);
+  RUN_TEST(test_rejects_a_broken_status_line);
+  RUN_TEST(test_chunks_are_unwrapped);
+  RUN_TEST(test_chunk_framing_split_anywhere);
+  RUN_TEST(test_rejects_an_oversized_chunk);
+  RUN_TEST(test_throughput);
+  return UNITY_END();
+}
@@ -0,0 +1,109 @@
+// SPI cost of one status bar icon update on the simulated panel: the
+// prerendered images (one pushImage) against drawing the same icon from
+// primitives, the way drawWifiIcon()/drawAPIcon() did before 0.5.0. Both
+// must also give the same pixels.
+
+#include <Arduino.h>
+#include <TFT_eSPI.h>
+#include <unity.h>
+
+#include "display_utils.h"
+#include "icons.h"
+
+#define ICON_X 205 // where the status bar puts it
+#define ICON_Y 4
+#define REFERENCE_Y 100 // primitives are drawn here for the comparison
+
+struct IconCost {
+  unsigned long windows;
+  unsigned long bytes;
+};
+
+// --- Drawn from Primitives ---
+
+static void primitiveWifiIcon(int x, int y, int bars) {
+  tft.fillRect(x, y, ICON_W, ICON_H, TFT_DARKGREY); // bar background
+  for (int i = 0; i < 4; i++) {
+    int h = (i + 1) * 4;
+    tft.fillRect(x + i * 4, y + (16 - h), 3, h,
+                 i < bars ? TFT_GREEN : TFT_BLACK);
+  }
+}
+
+static void primitiveAPIcon(int x, int y) {
+  tft.fillRect(x, y, ICON_W, ICON_H, TFT_DARKGREY);
+  tft.fillRoundRect(x, y, 24, 16, 3, TFT_ORANGE);
+  tft.setTextColor(TFT_BLACK, TFT_ORANGE);
+  tft.setTextSize(1);
+  tft.setCursor(x + 6, y + 4);
+  tft.print("AP");
+}
+
+// --- Measurement ---
+
+template <class Draw> static IconCost measure(Draw draw) {
+  StandInSpi before = tft.spi;
+  draw();
+  return {tft.spi.windows - before.windows, tft.spi.bytes - before.bytes};
+}
+
+static void report(const char *icon, const IconCost &prerendered,
+                   const IconCost &primitives) {
+  printf("%-8s prerendered %2lu windows %5lu bytes %4llu us | "
+         "primitives %2lu windows %5lu bytes %4llu us\n",
+         icon, prerendered.windows, prerendered.bytes,
+         (unsigned long long)displaySpiMicros(prerendered.bytes),
+         primitives.windows, primitives.bytes,
+         (unsigned long long)displaySpiMicros(primitives.bytes));
+}
+
+static void assertSamePixels() {
+  for (int y = 0; y < ICON_H; y++) {
+    for (int x = 0; x < ICON_W; x++) {
+      TEST_ASSERT_EQUAL_HEX16(tft.readPixel(ICON_X + x, REFERENCE_Y + y),
+                              tft.readPixel(ICON_X + x, ICON_Y + y));
+    }
+  }
+}
+
+void setUp() {
+  tft.init();
+  tft.setRotation(2);
+}
+
+void tearDown() {}
+
+static void test_wifi_icon_update_is_one_window() {
+  for (int bars = 0; bars < WIFI_ICON_LEVELS; bars++) {
+    IconCost icon =
+        measure([=] { drawWifiIcon(tft, ICON_X, ICON_Y, bars); });
+    IconCost reference =
+        measure([=] { primitiveWifiIcon(ICON_X, REFERENCE_Y, bars); });
+    char name[16];
+    snprintf(name, sizeof(name), "wifi %d", bars);
+    report(name, icon, reference);
+
+    TEST_ASSERT_EQUAL(1, icon.windows);
+    TEST_ASSERT_EQUAL(TFT_WINDOW_BYTES + ICON_W * ICON_H * 2, icon.bytes);
+    TEST_ASSERT_LESS_THAN(reference.windows, icon.windows);
+    assertSamePixels();
+  }
+}
+
+static void test_ap_icon_update_is_one_window() {
+  IconCost icon = measure([] { drawAPIcon(tft, ICON_X, ICON_Y); });
+  IconCost reference = measure([] { primitiveAPIcon(ICON_X, REFERENCE_Y); });
+  report("ap", icon, reference);
+
+  TEST_ASSERT_EQUAL(1, icon.windows);
+  TEST_ASSERT_EQUAL(TFT_WINDOW_BYTES + ICON_W * ICON_H * 2, icon.bytes);
+  TEST_ASSERT_LESS_THAN(reference.bytes, icon.bytes);
+  assertSamePixels();
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_wifi_icon_update_is_one_window);
+  RUN_TEST(test_ap_icon_update_is_one_window);
+  return UNITY_END();
+}
@@ -0,0 +1,184 @@
+// Loop latency while an RPC is in flight. Each loop() pass polls the client
+// once and time moves on 1 ms between passes, while the fake daemon answers
+// after a delay and in segments. Every pass must return quickly whatever
+// the network does; the request is spread over many passes instead.
+
+#include <Arduino.h>
+#include <unity.h>
+
+#include "fake_transmission.h"
+#include "transmission_client.h"
+
+#define LOOP_PASS_MS 1       // between two passes
+#define LOOP_BUDGET_US 5000  // longest acceptable poll()
+#define LOOP_MAX_PASSES 10000
+
+struct LoopLatency {
+  unsigned long passes;
+  unsigned long requestMs; // simulated time from start() to the result
+  unsigned long maxUs;     // longest single poll()
+  double meanUs;
+};
+
+static TransmissionClient client;
+// The whole session-stats reply, unfiltered
+static StaticJsonDocument<JSON_OBJECT_SIZE(8) + 128> result;
+
+static TransmissionSettings target() {
+  TransmissionSettings t = {};
+  t.port = 9091;
+  t.poll = SETTINGS_DEFAULT_POLL;
+  strcpy(t.host, "192.168.1.2");
+  strcpy(t.path, SETTINGS_DEFAULT_PATH);
+  strcpy(t.user, "transmission");
+  strcpy(t.pass, "correct horse battery");
+  return t;
+}
+
+// Runs one request the way loop() does and times every pass
+static LoopLatency runRequest(const char *name) {
+  LoopLatency l = {0, 0, 0, 0};
+  unsigned long totalUs = 0;
+  unsigned long started = millis();
+  TEST_ASSERT_TRUE(client.start("{\"method\":\"session-stats\"}", result));
+
+  while (!client.finished() && l.passes < LOOP_MAX_PASSES) {
+    unsigned long before = micros();
+    client.poll();
+    unsigned long us = micros() - before;
+    l.maxUs = max(l.maxUs, us);
+    totalUs += us;
+    l.passes++;
+    standInAdvance(LOOP_PASS_MS);
+  }
+  l.requestMs = millis() - started;
+  l.meanUs = (double)totalUs / l.passes;
+  printf("%-22s %5lu passes %5lu ms request | pass max %5lu us "
+         "mean %6.1f us\n",
+         name, l.passes, l.requestMs, l.maxUs, l.meanUs);
+
+  TEST_ASSERT_EQUAL_MESSAGE(RPC_DONE, client.state(), client.error().c_str());
+  return l;
+}
+
+void setUp() {
+  client.reset();
+  client.configure(target());
+}
+
+void tearDown() { client.reset(); }
+
+static void test_handshake_and_slow_reply() {
+  FakeTransmission daemon;
+  daemon.latency = 80;
+  LoopLatency l = runRequest("handshake, 80 ms");
+  TEST_ASSERT_EQUAL(1, daemon.handshakes);
+  // Two responses, each waited for over many short passes
+  TEST_ASSERT_GREATER_OR_EQUAL(160, l.requestMs);
+  TEST_ASSERT_GREATER_OR_EQUAL(100, l.passes);
+  TEST_ASSERT_LESS_THAN(LOOP_BUDGET_US, l.maxUs);
+}
+
+static void test_keep_alive_reply_in_segments() {
+  FakeTransmission daemon;
+  daemon.latency = 30;
+  daemon.segment = 64;
+  runRequest("warm-up");
+  unsigned long reconnects = client.reconnects();
+  LoopLatency l = runRequest("keep-alive, 64 B");
+  TEST_ASSERT_EQUAL(reconnects, client.reconnects()); // same socket
+  TEST_ASSERT_LESS_THAN(LOOP_BUDGET_US, l.maxUs);
+}
+
+static void test_chunked_reply() {
+  FakeTransmission daemon;
+  daemon.latency = 30;
+  daemon.chunked = true;
+  runRequest("warm-up");
+  LoopLatency l = runRequest("chunked");
+  TEST_ASSERT_LESS_THAN(LOOP_BUDGET_US, l.maxUs);
+}
+
+static void test_connection_close() {
+  FakeTransmission daemon;
+  daemon.latency = 30;
+  daemon.keepAlive = false;
+  runRequest("warm-up");
+  unsigned long reconnects = client.reconnects();
+  LoopLatency l = runRequest("connection close");
+  TEST_ASSERT_EQUAL(reconnects + 1, client.reconnects());
+  TEST_ASSERT_LESS_THAN(LOOP_BUDGET_US, l.maxUs);
+}
+
+static void test_body_that_trickles_in() {
+  // The headers and the start of the body come at once, the rest of the
+  // body in pieces 40 ms apart
+  FakeTransmission daemon;
+  daemon.segment = 120;
+  daemon.gap = 40;
+  runRequest("warm-up");
+  LoopLatency l = runRequest("body in 40 ms gaps");
+  TEST_ASSERT_GREATER_OR_EQUAL(40, l.requestMs);
+  TEST_ASSERT_LESS_THAN(LOOP_BUDGET_US, l.maxUs);
+}
+
+static void test_chunked_body_that_trickles_in() {
+  FakeTransmission daemon;
+  daemon.chunked = true;
+  daemon.segment = 64;
+  daemon.gap = RPC_BODY_SETTLE_MS / 2;
+  runRequest("warm-up");
+  LoopLatency l = runRequest("chunked in 10 ms gaps");
+  TEST_ASSERT_LESS_THAN(LOOP_BUDGET_US, l.maxUs);
+}
+
+static void test_stalled_chunked_body_fails_within_the_wait_limit() {
+  // A pause longer than RPC_BODY_SETTLE_MS looks like the end of the body,
+  // so the parser starts early and then has to wait
+  FakeTransmission daemon;
+  daemon.chunked = true;
+  daemon.segment = 150;
+  daemon.gap = 500;
+
+  TEST_ASSERT_TRUE(client.start("{\"method\":\"session-stats\"}", result));
+  unsigned long maxUs = 0;
+  while (!client.finished()) {
+    unsigned long before = micros();
+    client.poll();
+    maxUs = max(maxUs, micros() - before);
+    standInAdvance(LOOP_PASS_MS);
+  }
+  printf("%-22s pass max %5lu us\n", "chunked, stalled", maxUs);
+  TEST_ASSERT_EQUAL(RPC_FAILED, client.state());
+  TEST_ASSERT_EQUAL_STRING("JSON Parse Err", client.error().c_str());
+  TEST_ASSERT_UINT32_WITHIN(LOOP_BUDGET_US, RPC_PARSE_WAIT_MS * 1000UL,
+                            maxUs);
+}
+
+static void test_longest_credentials_are_sent() {
+  TransmissionSettings t = target();
+  memset(t.user, 'u', SETTINGS_USER_LEN - 1);
+  memset(t.pass, 'p', SETTINGS_PASS_LEN - 1);
+  client.configure(t);
+  FakeTransmission daemon;
+  runRequest("longest credentials");
+
+  // "Basic " and the base64 of all of "user:pass"
+  size_t len = SETTINGS_USER_LEN + SETTINGS_PASS_LEN - 1;
+  TEST_ASSERT_EQUAL(6 + (len + 2) / 3 * 4, daemon.lastAuthorization.size());
+  TEST_ASSERT_EQUAL_STRING("Basic dXV1",
+                           daemon.lastAuthorization.substr(0, 10).c_str());
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_handshake_and_slow_reply);
+  RUN_TEST(test_keep_alive_reply_in_segments);
+  RUN_TEST(test_chunked_reply);
+  RUN_TEST(test_connection_close);
+  RUN_TEST(test_body_that_trickles_in);
+  RUN_TEST(test_chunked_body_that_trickles_in);
+  RUN_TEST(test_stalled_chunked_body_fails_within_the_wait_limit);
+  RUN_TEST(test_longest_credentials_are_sent);
+  return UNITY_END();
+}
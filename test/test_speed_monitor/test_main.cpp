@@ -0,0 +1,83 @@
+// The speed monitor against a daemon that refuses connections: polls back
+// off exponentially up to SPEED_BACKOFF_MAX, the torrent list sharing the
+// client stays off the host too, and a success brings back the interval.
+
+#include <Arduino.h>
+#include <unity.h>
+
+#include "display_utils.h"
+#include "fake_transmission.h"
+#include "speed_monitor.h"
+#include "torrent_list.h"
+
+#define MONITOR_PASS_MS 100 // one loop() pass
+
+static TransmissionSettings target() {
+  TransmissionSettings t = {};
+  t.port = 9091;
+  t.poll = 2;
+  strcpy(t.host, "192.168.1.2");
+  strcpy(t.path, SETTINGS_DEFAULT_PATH);
+  return t;
+}
+
+static void run(unsigned long ms) {
+  for (unsigned long t = 0; t < ms; t += MONITOR_PASS_MS) {
+    speedMonitorLoop();
+    torrentListLoop();
+    standInAdvance(MONITOR_PASS_MS);
+  }
+}
+
+void setUp() {
+  speedMonitorConfigure(target());
+  torrentListConfigure(target());
+}
+
+void tearDown() {}
+
+static void test_failed_polls_back_off() {
+  FakeTransmission daemon;
+  daemon.refuse = true;
+  TransmissionClient &client = speedMonitorClient();
+  unsigned long attempts = client.requests();
+
+  // Polls at 0, 4, 12, 28 and 60 s, then one a minute from 120 s: 13 in
+  // 10 min, where a poll every 2 s would have been 300
+  run(10 * 60000UL);
+  unsigned long failed = client.requests() - attempts;
+  printf("%lu connection attempts in 10 min\n", failed);
+  TEST_ASSERT_UINT32_WITHIN(1, 13, failed);
+  TEST_ASSERT_FALSE(speedMonitorValid());
+
+  // Back: the next poll, at most a minute away, succeeds and the interval
+  // is the configured one again
+  daemon.refuse = false;
+  run(SPEED_BACKOFF_MAX);
+  TEST_ASSERT_TRUE(speedMonitorValid());
+  uint32_t samples = speedSampleCount();
+  run(20000);
+  TEST_ASSERT_UINT32_WITHIN(1, 10, speedSampleCount() - samples);
+}
+
+static void test_backoff_never_shortens_a_long_interval() {
+  TransmissionSettings slow = target();
+  slow.poll = 90;
+  speedMonitorConfigure(slow);
+  torrentListConfigure(slow);
+  FakeTransmission daemon;
+  daemon.refuse = true;
+  TransmissionClient &client = speedMonitorClient();
+  unsigned long attempts = client.requests();
+
+  run(10 * 60000UL);
+  // One at 0 s, then every 90 s
+  TEST_ASSERT_UINT32_WITHIN(1, 7, client.requests() - attempts);
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_failed_polls_back_off);
+  RUN_TEST(test_backoff_never_shortens_a_long_interval);
+  return UNITY_END();
+}
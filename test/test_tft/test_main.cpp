@@ -0,0 +1,272 @@
+// Display output on the simulated panel: what lands in the framebuffer and
+// what it costs on the SPI bus, checked against the firmware's own
+// accounting (displayTraffic, statusBarLastBytes, compositorFrameBytes).
+// Set TFT_DUMP_DIR to also write each screen as a PPM image.
+
+#include <Arduino.h>
+#include <ESP8266WiFi.h>
+#include <TFT_eSPI.h>
+#include <unity.h>
+
+#include "compositor.h"
+#include "display_utils.h"
+#include "icons.h"
+
+static StandInSpi spiBefore;
+static DisplayTraffic trafficBefore;
+
+static void mark() {
+  spiBefore = tft.spi;
+  trafficBefore = displayTraffic;
+}
+
+static unsigned long busBytes() { return tft.spi.bytes - spiBefore.bytes; }
+
+static unsigned long busWindows() {
+  return tft.spi.windows - spiBefore.windows;
+}
+
+// The firmware's counters must have seen exactly what went over the bus
+static void assertAccounted() {
+  TEST_ASSERT_EQUAL(busWindows(),
+                    displayTraffic.windows - trafficBefore.windows);
+  TEST_ASSERT_EQUAL(tft.spi.pixels - spiBefore.pixels,
+                    displayTraffic.pixels - trafficBefore.pixels);
+  TEST_ASSERT_EQUAL(busBytes(), displayTraffic.bytes - trafficBefore.bytes);
+}
+
+static void dump(const char *name) {
+  const char *dir = getenv("TFT_DUMP_DIR");
+  if (!dir)
+    return;
+  char path[256];
+  snprintf(path, sizeof(path), "%s/%s.ppm", dir, name);
+  TEST_ASSERT_TRUE(tft.dumpPPM(path));
+}
+
+static void flushAll() {
+  for (int i = 0; i < 100 && !compositorIdle(); i++)
+    compositorFlush();
+  TEST_ASSERT_TRUE(compositorIdle());
+}
+
+void setUp() {
+  tft.init();
+  tft.setRotation(2);
+  tft.spi = {0, 0, 0};
+}
+
+void tearDown() {}
+
+// --- Panel ---
+
+static void test_window_costs_framing_plus_pixels() {
+  tft.fillRect(0, 0, 240, 25, TFT_DARKGREY);
+  TEST_ASSERT_EQUAL(1, tft.spi.windows);
+  TEST_ASSERT_EQUAL(240 * 25, tft.spi.pixels);
+  TEST_ASSERT_EQUAL(TFT_WINDOW_BYTES + 240 * 25 * 2, tft.spi.bytes);
+  TEST_ASSERT_EQUAL(TFT_DARKGREY, tft.readPixel(239, 24));
+  TEST_ASSERT_EQUAL(TFT_BLACK, tft.readPixel(0, 25));
+}
+
+static void test_clipped_window_counts_visible_pixels() {
+  tft.fillRect(-10, -10, 20, 20, TFT_RED);
+  TEST_ASSERT_EQUAL(1, tft.spi.windows);
+  TEST_ASSERT_EQUAL(100, tft.spi.pixels);
+
+  tft.fillRect(240, 0, 10, 10, TFT_RED); // fully outside: nothing is sent
+  TEST_ASSERT_EQUAL(1, tft.spi.windows);
+}
+
+static void test_text_with_background_is_one_window_per_char() {
+  tft.setTextSize(1);
+  tft.setTextColor(TFT_WHITE, TFT_BLACK);
+  tft.setCursor(0, 0);
+  tft.print("AP");
+  TEST_ASSERT_EQUAL(2, tft.spi.windows);
+  TEST_ASSERT_EQUAL(2 * (TFT_WINDOW_BYTES + 6 * 8 * 2), tft.spi.bytes);
+  // 'A' column 0 is 0x7C: rows 2-6 set
+  TEST_ASSERT_EQUAL(TFT_BLACK, tft.readPixel(0, 1));
+  TEST_ASSERT_EQUAL(TFT_WHITE, tft.readPixel(0, 2));
+}
+
+static void test_narrow_push_sprite_is_a_window_per_row() {
+  TFT_eSprite sprite(&tft);
+  sprite.setColorDepth(16);
+  TEST_ASSERT_NOT_NULL(sprite.createSprite(40, 10));
+  sprite.fillSprite(TFT_RED);
+
+  mark();
+  sprite.pushSprite(0, 0, 0, 0, 40, 10); // whole rows: one block
+  TEST_ASSERT_EQUAL(1, busWindows());
+  mark();
+  sprite.pushSprite(5, 0, 5, 0, 20, 10);
+  TEST_ASSERT_EQUAL(10, busWindows());
+  TEST_ASSERT_EQUAL(10 * (TFT_WINDOW_BYTES + 20 * 2), busBytes());
+  sprite.deleteSprite();
+}
+
+static void test_bus_time_at_spi_frequency() {
+  tft.fillScreen(TFT_BLACK);
+  TEST_ASSERT_EQUAL(displaySpiMicros(tft.spi.bytes), tft.spi.micros());
+  // A full frame is about 45 ms at 27 MHz
+  TEST_ASSERT_UINT32_WITHIN(1000, 45511, tft.spi.micros());
+}
+
+// --- Icons ---
+
+static void test_panel_icon_keeps_its_colours() {
+  drawAPIcon(tft, 10, 10);
+  TEST_ASSERT_EQUAL(1, tft.spi.windows);
+  for (int i = 0; i < ICON_W * ICON_H; i++)
+    TEST_ASSERT_EQUAL_HEX16(ap_icon[i],
+                            tft.readPixel(10 + i % ICON_W, 10 + i / ICON_W));
+  TEST_ASSERT_FALSE(tft.getSwapBytes());
+}
+
+static void test_icon_widget_keeps_its_colours() {
+  compositorBegin(TFT_BLACK);
+  widgetIcon(40, 100, ICON_W, ICON_H, ap_icon);
+  flushAll();
+  for (int i = 0; i < ICON_W * ICON_H; i++)
+    TEST_ASSERT_EQUAL_HEX16(ap_icon[i],
+                            tft.readPixel(40 + i % ICON_W, 100 + i / ICON_W));
+}
+
+// --- Status Bar ---
+
+static void test_status_bar_accounting_matches_the_bus() {
+  WiFi.rssi = -55;
+  WiFi.begin("home", "secret");
+  currentState = STATE_CONNECTED;
+
+  mark();
+  drawStatusBar(); // first draw: the whole bar
+  TEST_ASSERT_EQUAL(1, busWindows());
+  TEST_ASSERT_EQUAL(statusBarLastBytes, busBytes());
+  TEST_ASSERT_EQUAL(TFT_WINDOW_BYTES + 240 * 25 * 2, busBytes());
+  assertAccounted();
+  // Four green bars from the 8-bit sprite, first one at x = 205
+  TEST_ASSERT_EQUAL_HEX16(TFT_GREEN, tft.readPixel(205, 19));
+  TEST_ASSERT_EQUAL_HEX16(TFT_GREEN, tft.readPixel(217, 4));
+  dump("status_bar_connected");
+
+  mark();
+  drawStatusBar(); // unchanged: nothing goes out
+  TEST_ASSERT_EQUAL(0, busWindows());
+
+  WiFi.rssi = -75; // two bars
+  mark();
+  drawStatusBar();
+  TEST_ASSERT_EQUAL(1, busWindows());
+  TEST_ASSERT_EQUAL(statusBarLastBytes, busBytes());
+  TEST_ASSERT_EQUAL(TFT_WINDOW_BYTES + ICON_W * ICON_H * 2, busBytes());
+  assertAccounted();
+  TEST_ASSERT_EQUAL_HEX16(TFT_BLACK, tft.readPixel(217, 4));
+
+  // A new address: only the IP lines, still one window
+  WiFi.ip = IPAddress(10, 0, 0, 7);
+  mark();
+  drawStatusBar();
+  TEST_ASSERT_EQUAL(1, busWindows());
+  TEST_ASSERT_EQUAL(statusBarLastBytes, busBytes());
+  assertAccounted();
+  TEST_ASSERT_LESS_THAN(TFT_WINDOW_BYTES + 240 * 25 * 2, busBytes());
+  // "10.0" on the first line: the 1 starts with its top-left serif
+  TEST_ASSERT_EQUAL_HEX16(standInColor8to16(standInColor16to8(TFT_DARKGREY)),
+                          tft.readPixel(5, 4));
+  TEST_ASSERT_EQUAL_HEX16(TFT_WHITE, tft.readPixel(7, 4));
+  TEST_ASSERT_EQUAL_HEX16(TFT_GREEN, tft.readPixel(205, 19)); // unchanged
+  WiFi.ip = IPAddress(192, 168, 1, 50);
+}
+
+// --- Compositor ---
+
+static void test_compositor_accounting_matches_the_bus() {
+  currentScreen = SCREEN_SPEED;
+  compositorBegin(TFT_BLACK);
+  speedViewBegin();
+  drawSpeedView(true, 1843200, 524288);
+
+  mark();
+  unsigned long lastFlush = 0;
+  for (int i = 0; i < 100 && !compositorIdle(); i++) {
+    unsigned long before = tft.spi.bytes;
+    compositorFlush();
+    lastFlush = tft.spi.bytes - before;
+    TEST_ASSERT_LESS_OR_EQUAL(COMP_FRAME_BUDGET + COMP_AREA_W * COMP_STRIP_H,
+                              (tft.spi.bytes - before) / 2);
+  }
+  TEST_ASSERT_TRUE(compositorIdle());
+  TEST_ASSERT_EQUAL(compositorFrameBytes(), lastFlush);
+  assertAccounted();
+  // A full repaint of the main area, strip by strip
+  TEST_ASSERT_EQUAL(COMP_AREA_W * COMP_AREA_H, tft.spi.pixels - spiBefore.pixels);
+  dump("speed_view");
+
+  // One digit changes: only its cells go out
+  mark();
+  drawSpeedView(true, 1843200, 530000);
+  flushAll();
+  assertAccounted();
+  TEST_ASSERT_LESS_THAN(COMP_AREA_W * 24, tft.spi.pixels - spiBefore.pixels);
+}
+
+static void renderColumns(TFT_eSPI &gfx, int ox, int oy,
+                          const WidgetClip &clip) {
+  for (int x = clip.x; x < clip.x + clip.w; x++)
+    gfx.drawFastVLine(x + ox, clip.y + oy, clip.h, x & 1 ? TFT_RED : TFT_BLUE);
+}
+
+static void test_narrow_rect_is_one_window_per_strip() {
+  // A 1 px graph column, 120 px tall: one window per strip, not per row
+  compositorBegin(TFT_BLACK);
+  int graph = widgetCustom(0, 100, COMP_AREA_W, 120, renderColumns);
+  flushAll();
+
+  mark();
+  widgetInvalidateRect(graph, 37, 0, 1, 120);
+  flushAll();
+  assertAccounted();
+  TEST_ASSERT_EQUAL(120, tft.spi.pixels - spiBefore.pixels);
+  TEST_ASSERT_EQUAL((120 + COMP_STRIP_H - 1) / COMP_STRIP_H, busWindows());
+  TEST_ASSERT_EQUAL_HEX16(TFT_RED, tft.readPixel(37, 100));
+  TEST_ASSERT_EQUAL_HEX16(TFT_RED, tft.readPixel(37, 219));
+  TEST_ASSERT_EQUAL_HEX16(TFT_BLUE, tft.readPixel(38, 219));
+}
+
+static void test_ppm_dump() {
+  tft.fillRect(0, 0, 1, 1, TFT_RED);
+  const char *path = "/tmp/tft_stand_in_test.ppm";
+  TEST_ASSERT_TRUE(tft.dumpPPM(path));
+
+  FILE *f = fopen(path, "rb");
+  TEST_ASSERT_NOT_NULL(f);
+  char header[16] = {0};
+  TEST_ASSERT_EQUAL(15, fread(header, 1, 15, f));
+  TEST_ASSERT_EQUAL_STRING("P6\n240 320\n255\n", header);
+  uint8_t rgb[3];
+  TEST_ASSERT_EQUAL(3, fread(rgb, 1, 3, f));
+  TEST_ASSERT_EQUAL(255, rgb[0]);
+  TEST_ASSERT_EQUAL(0, rgb[1]);
+  fseek(f, 0, SEEK_END);
+  TEST_ASSERT_EQUAL(15 + 240 * 320 * 3, ftell(f));
+  fclose(f);
+  remove(path);
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_window_costs_framing_plus_pixels);
+  RUN_TEST(test_clipped_window_counts_visible_pixels);
+  RUN_TEST(test_text_with_background_is_one_window_per_char);
+  RUN_TEST(test_narrow_push_sprite_is_a_window_per_row);
+  RUN_TEST(test_bus_time_at_spi_frequency);
+  RUN_TEST(test_panel_icon_keeps_its_colours);
+  RUN_TEST(test_icon_widget_keeps_its_colours);
+  RUN_TEST(test_status_bar_accounting_matches_the_bus);
+  RUN_TEST(test_compositor_accounting_matches_the_bus);
+  RUN_TEST(test_narrow_rect_is_one_window_per_strip);
+  RUN_TEST(test_ppm_dump);
+  return UNITY_END();
+}
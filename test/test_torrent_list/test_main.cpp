@@ -0,0 +1,256 @@
+// The torrent list next to the speed monitor against the fake daemon: both
+// go through one client, so one socket and one session id serve them, and
+// the speed samples keep their pace while the list is kept in sync.
+
+#include <Arduino.h>
+#include <unity.h>
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "display_utils.h"
+#include "fake_transmission.h"
+#include "speed_monitor.h"
+#include "torrent_list.h"
+
+#define LIST_PASS_MS 100 // one loop() pass
+#define LIST_RUN_MS 60000UL
+
+struct Requests {
+  unsigned long stats;
+  unsigned long deltas;
+  unsigned long pages;
+};
+
+static TransmissionSettings target() {
+  TransmissionSettings t = {};
+  t.port = 9091;
+  t.poll = 2;
+  strcpy(t.host, "192.168.1.2");
+  strcpy(t.path, SETTINGS_DEFAULT_PATH);
+  return t;
+}
+
+// The server's torrents by id; empty unless a test adds some. Deltas report
+// the active ones and the ids removed, as "recently-active" does.
+struct Torrent {
+  std::string name;
+  uint32_t down;
+  uint32_t up;
+};
+
+static std::map<uint32_t, Torrent> torrents;
+static std::set<uint32_t> active;
+static std::vector<uint32_t> removed;
+static Requests requests;
+
+static void appendTorrent(std::string &out, uint32_t id, const Torrent &t,
+                          bool name) {
+  char row[160];
+  snprintf(row, sizeof(row),
+           "%s{\"eta\":-1,\"id\":%lu,%s%s%s\"percentDone\":0.5,"
+           "\"rateDownload\":%lu,\"rateUpload\":%lu,\"status\":4}",
+           out.back() == '[' ? "" : ",", (unsigned long)id,
+           name ? "\"name\":\"" : "", name ? t.name.c_str() : "",
+           name ? "\"," : "", (unsigned long)t.down, (unsigned long)t.up);
+  out += row;
+}
+
+// Answers each method the way Transmission does
+static std::string reply(const std::string &payload) {
+  if (payload.find("session-stats") != std::string::npos) {
+    requests.stats++;
+    return "{\"arguments\":{\"downloadSpeed\":1843200,\"torrentCount\":" +
+           std::to_string(torrents.size()) +
+           ",\"uploadSpeed\":524288},\"result\":\"success\"}";
+  }
+
+  bool name = payload.find("\"name\"") != std::string::npos;
+  std::string out = "{\"arguments\":{\"removed\":[";
+  std::string rows = "[";
+  if (payload.find("recently-active") != std::string::npos) {
+    requests.deltas++;
+    for (size_t i = 0; i < removed.size(); i++)
+      out += (i ? "," : "") + std::to_string(removed[i]);
+    for (uint32_t id : active)
+      appendTorrent(rows, id, torrents[id], name);
+  } else {
+    requests.pages++;
+    const char *p = payload.c_str() + payload.find("\"ids\":[") + 7;
+    while (*p != ']') {
+      uint32_t id = strtoul(p, (char **)&p, 10);
+      if (torrents.count(id))
+        appendTorrent(rows, id, torrents[id], name);
+      if (*p == ',')
+        p++;
+    }
+  }
+  return out + "]," + "\"torrents\":" + rows + "]},\"result\":\"success\"}";
+}
+
+// Runs loop() passes for ms of simulated time
+static void run(unsigned long ms) {
+  for (unsigned long t = 0; t < ms; t += LIST_PASS_MS) {
+    speedMonitorLoop();
+    torrentListLoop();
+    standInAdvance(LIST_PASS_MS);
+  }
+}
+
+void setUp() {
+  requests = {0, 0, 0};
+  torrents.clear();
+  active.clear();
+  removed.clear();
+  speedMonitorConfigure(target());
+  torrentListConfigure(target());
+}
+
+void tearDown() {}
+
+static void test_shares_the_speed_monitors_session() {
+  FakeTransmission daemon;
+  daemon.reply = reply;
+  TransmissionClient &client = speedMonitorClient();
+  unsigned long reconnects = client.reconnects();
+  unsigned long samples = speedSampleCount();
+
+  run(LIST_RUN_MS);
+  printf("%lu session-stats, %lu deltas, %lu pages, %lu handshakes\n",
+         requests.stats, requests.deltas, requests.pages, daemon.handshakes);
+
+  TEST_ASSERT_EQUAL(1, daemon.handshakes);
+  TEST_ASSERT_EQUAL(reconnects + 1, client.reconnects());
+  TEST_ASSERT_TRUE(torrentListSynced());
+  // A delta every TORRENT_POLL_INTERVAL after the sync, a pass later when
+  // the speed monitor has the client; a speed sample every 2 s
+  TEST_ASSERT_UINT32_WITHIN(2, LIST_RUN_MS / TORRENT_POLL_INTERVAL - 1,
+                            requests.deltas);
+  TEST_ASSERT_UINT32_WITHIN(1, LIST_RUN_MS / 2000,
+                            speedSampleCount() - samples);
+  TEST_ASSERT_TRUE(speedMonitorValid());
+}
+
+static void test_unchanged_list_raises_no_change() {
+  FakeTransmission daemon;
+  daemon.reply = reply;
+  run(TORRENT_POLL_INTERVAL); // the sync
+  TEST_ASSERT_TRUE(torrentListSynced());
+
+  uint32_t changes = torrentListChanges();
+  run(LIST_RUN_MS);
+  TEST_ASSERT_GREATER_OR_EQUAL(10, requests.deltas);
+  TEST_ASSERT_EQUAL(changes, torrentListChanges());
+}
+
+static void test_disconnect_starts_a_new_sync() {
+  FakeTransmission daemon;
+  daemon.reply = reply;
+  run(TORRENT_POLL_INTERVAL);
+  TEST_ASSERT_TRUE(torrentListSynced());
+  uint32_t changes = torrentListChanges();
+
+  currentState = STATE_CONNECTING;
+  run(LIST_PASS_MS);
+  currentState = STATE_CONNECTED;
+  TEST_ASSERT_FALSE(torrentListSynced());
+  TEST_ASSERT_NOT_EQUAL(changes, torrentListChanges());
+
+  run(TORRENT_POLL_INTERVAL);
+  TEST_ASSERT_TRUE(torrentListSynced());
+}
+
+// Ids left by deleted torrents: gaps within a page, and one run of empty
+// pages long enough for a recount
+static const uint32_t sparseIds[] = {2,  3,  5,  9,  17,  18,  40,  41,  42,
+                                     77, 78, 90, 91, 300, 301, 302, 350};
+#define SPARSE_COUNT (sizeof(sparseIds) / sizeof(sparseIds[0]))
+
+static void addSparseTorrents() {
+  for (uint32_t id : sparseIds)
+    torrents[id] = {"Torrent " + std::to_string(id), id * 1024, id * 256};
+}
+
+static int findTorrent(uint32_t id) {
+  for (int i = 0; i < torrentCount(); i++) {
+    if (torrentAt(i).id == id)
+      return i;
+  }
+  return -1;
+}
+
+static void syncSparseTorrents() {
+  addSparseTorrents();
+  for (int pass = 0; pass < 60 && !torrentListSynced(); pass++)
+    run(TORRENT_POLL_INTERVAL);
+  TEST_ASSERT_TRUE(torrentListSynced());
+}
+
+static void test_sync_finds_every_sparse_id() {
+  FakeTransmission daemon;
+  daemon.reply = reply;
+  syncSparseTorrents();
+  printf("%u torrents in %lu pages\n", (unsigned)SPARSE_COUNT,
+         requests.pages);
+
+  TEST_ASSERT_EQUAL(SPARSE_COUNT, torrentTotal());
+  TEST_ASSERT_EQUAL(SPARSE_COUNT, torrentCount());
+  for (uint32_t id : sparseIds) {
+    int i = findTorrent(id);
+    TEST_ASSERT_GREATER_OR_EQUAL(0, i);
+    TEST_ASSERT_EQUAL_STRING(torrents[id].name.c_str(), torrentAt(i).name);
+    TEST_ASSERT_EQUAL(id * 1024, torrentAt(i).down);
+  }
+  // Most active first
+  for (int i = 1; i < torrentCount(); i++)
+    TEST_ASSERT_GREATER_THAN(torrentAt(i).down, torrentAt(i - 1).down);
+}
+
+static void test_delta_update_raises_one_change() {
+  FakeTransmission daemon;
+  daemon.reply = reply;
+  syncSparseTorrents();
+  uint32_t changes = torrentListChanges();
+  unsigned long deltas = requests.deltas;
+
+  // Reported by every delta from now on, the same each time
+  torrents[41].down = 9000000;
+  active.insert(41);
+  run(3 * TORRENT_POLL_INTERVAL);
+  TEST_ASSERT_GREATER_OR_EQUAL(deltas + 2, requests.deltas);
+
+  TEST_ASSERT_EQUAL(changes + 1, torrentListChanges());
+  TEST_ASSERT_EQUAL(41, torrentAt(0).id);
+  TEST_ASSERT_EQUAL(9000000, torrentAt(0).down);
+  TEST_ASSERT_EQUAL_STRING("Torrent 41", torrentAt(0).name);
+  TEST_ASSERT_EQUAL(SPARSE_COUNT, torrentCount());
+}
+
+static void test_removed_id_drops_the_entry() {
+  FakeTransmission daemon;
+  daemon.reply = reply;
+  syncSparseTorrents();
+  uint32_t changes = torrentListChanges();
+
+  torrents.erase(90);
+  removed.push_back(90);
+  run(2 * TORRENT_POLL_INTERVAL);
+
+  TEST_ASSERT_TRUE(torrentListSynced());
+  TEST_ASSERT_EQUAL(-1, findTorrent(90));
+  TEST_ASSERT_EQUAL(SPARSE_COUNT - 1, torrentCount());
+  TEST_ASSERT_EQUAL(changes + 1, torrentListChanges());
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_shares_the_speed_monitors_session);
+  RUN_TEST(test_unchanged_list_raises_no_change);
+  RUN_TEST(test_disconnect_starts_a_new_sync);
+  RUN_TEST(test_sync_finds_every_sparse_id);
+  RUN_TEST(test_delta_update_raises_one_change);
+  RUN_TEST(test_removed_id_drops_the_entry);
+  return UNITY_END();
+}
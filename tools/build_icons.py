@@ -0,0 +1,146 @@
+"""Renders the status bar icons into include/icons.h.
+
+Runs as a PlatformIO pre-build script (see extra_scripts in platformio.ini)
+or standalone: python3 tools/build_icons.py
+
+Each icon is an ICON_W x ICON_H RGB565 image in PROGMEM, drawn here the way
+the firmware used to draw it at runtime (bars as filled rects, the AP badge
+as a rounded rect with GLCD-font text), so an icon update is one pushImage.
+"""
+
+import os
+
+try:
+    Import("env")  # noqa: F821 - provided by PlatformIO/SCons
+    PROJECT_DIR = env.subst("$PROJECT_DIR")  # noqa: F821
+except NameError:
+    PROJECT_DIR = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+
+OUTPUT = os.path.join(PROJECT_DIR, "include", "icons.h")
+
+ICON_W = 24
+ICON_H = 16
+
+# TFT_eSPI colour constants
+TFT_BLACK = 0x0000
+TFT_GREEN = 0x07E0
+TFT_DARKGREY = 0x7BEF
+TFT_ORANGE = 0xFDA0
+
+BACKGROUND = TFT_DARKGREY  # status bar background
+
+# GLCD font columns (bit 0 = top row), from TFT_eSPI's glcdfont.c
+GLCD = {
+    "A": [0x7C, 0x12, 0x11, 0x12, 0x7C],
+    "P": [0x7F, 0x09, 0x09, 0x09, 0x06],
+}
+
+
+class Image:
+    def __init__(self):
+        self.px = [BACKGROUND] * (ICON_W * ICON_H)
+
+    def pixel(self, x, y, color):
+        if 0 <= x < ICON_W and 0 <= y < ICON_H:
+            self.px[y * ICON_W + x] = color
+
+    def fill_rect(self, x, y, w, h, color):
+        for yy in range(y, y + h):
+            for xx in range(x, x + w):
+                self.pixel(xx, yy, color)
+
+    def hline(self, x, y, w, color):
+        self.fill_rect(x, y, w, 1, color)
+
+    def fill_circle_helper(self, x0, y0, r, corner, delta, color):
+        # Same stepping as TFT_eSPI::fillCircleHelper, so corners match
+        f = 1 - r
+        ddf_x = 1
+        ddf_y = -r - r
+        y = 0
+        delta += 1
+        while y < r:
+            if f >= 0:
+                if corner & 1:
+                    self.hline(x0 - y, y0 + r, y + y + delta, color)
+                if corner & 2:
+                    self.hline(x0 - y, y0 - r, y + y + delta, color)
+                r -= 1
+                ddf_y += 2
+                f += ddf_y
+            y += 1
+            ddf_x += 2
+            f += ddf_x
+            if corner & 1:
+                self.hline(x0 - r, y0 + y, r + r + delta, color)
+            if corner & 2:
+                self.hline(x0 - r, y0 - y, r + r + delta, color)
+
+    def fill_round_rect(self, x, y, w, h, r, color):
+        self.fill_rect(x, y + r, w, h - r - r, color)
+        self.fill_circle_helper(x + r, y + h - r - 1, r, 1, w - r - r - 1, color)
+        self.fill_circle_helper(x + r, y + r, r, 2, w - r - r - 1, color)
+
+    def text(self, x, y, text, color, bg):
+        for ch in text:
+            columns = GLCD[ch] + [0]
+            for cx, bits in enumerate(columns):
+                for cy in range(8):
+                    self.pixel(x + cx, y + cy, color if bits >> cy & 1 else bg)
+            x += 6
+
+
+def wifi_icon(bars):
+    img = Image()
+    for i in range(4):
+        h = (i + 1) * 4
+        img.fill_rect(i * 4, ICON_H - h, 3, h, TFT_GREEN if i < bars else TFT_BLACK)
+    return img
+
+
+def ap_icon():
+    img = Image()
+    img.fill_round_rect(0, 0, 24, 16, 3, TFT_ORANGE)
+    img.text(6, 4, "AP", TFT_BLACK, TFT_ORANGE)
+    return img
+
+
+def c_image(img):
+    rows = []
+    for y in range(ICON_H):
+        row = img.px[y * ICON_W:(y + 1) * ICON_W]
+        rows.append("    " + ", ".join("0x%04x" % c for c in row) + ",")
+    return "\n".join(rows)
+
+
+def main():
+    levels = "\n".join(
+        "  { // %d bars\n%s\n  }," % (bars, c_image(wifi_icon(bars)))
+        for bars in range(5)
+    )
+    header = (
+        "// Generated by tools/build_icons.py - do not edit.\n"
+        "#ifndef ICONS_H\n"
+        "#define ICONS_H\n\n"
+        "#include <Arduino.h>\n\n"
+        "#define ICON_W %d\n"
+        "#define ICON_H %d\n"
+        "#define WIFI_ICON_LEVELS 5\n\n"
+        "// RGB565, row-major, on the status bar background\n"
+        "const uint16_t wifi_icons[WIFI_ICON_LEVELS][ICON_W * ICON_H] PROGMEM = {\n"
+        "%s\n};\n\n"
+        "const uint16_t ap_icon[ICON_W * ICON_H] PROGMEM = {\n%s\n};\n\n"
+        "#endif\n" % (ICON_W, ICON_H, levels, c_image(ap_icon()))
+    )
+
+    # Only touch the header when it changes, to avoid needless rebuilds
+    if os.path.exists(OUTPUT):
+        with open(OUTPUT, encoding="utf-8") as f:
+            if f.read() == header:
+                return
+    with open(OUTPUT, "w", encoding="utf-8") as f:
+        f.write(header)
+    print("Generated " + os.path.relpath(OUTPUT, PROJECT_DIR))
+
+
+main()
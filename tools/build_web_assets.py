@@ -0,0 +1,117 @@
+"""Minifies and gzips web/*.html into include/web_assets.h.
+
+Runs as a PlatformIO pre-build script (see extra_scripts in platformio.ini)
+or standalone: python3 tools/build_web_assets.py
+
+Each page becomes a PROGMEM byte array served with Content-Encoding: gzip
+and a content-hash ETag. %PLACEHOLDER% markers are replaced with "--"; the
+dashboard fills in the real values from /info.
+
+Pages with placeholders are also emitted as an uncompressed template: the
+static text split into PROGMEM segments, each followed by a TPL_* slot id,
+for clients that do not accept gzip (see template_renderer.h).
+"""
+
+import gzip
+import hashlib
+import os
+import re
+
+try:
+    Import("env")  # noqa: F821 - provided by PlatformIO/SCons
+    PROJECT_DIR = env.subst("$PROJECT_DIR")  # noqa: F821
+except NameError:
+    PROJECT_DIR = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+
+PAGES = ["index", "dashboard"]
+OUTPUT = os.path.join(PROJECT_DIR, "include", "web_assets.h")
+PLACEHOLDER = re.compile(r"%[A-Z_]+%")
+
+
+def minify(html):
+    html = re.sub(r"<!--.*?-->", "", html, flags=re.S)
+    html = re.sub(r"/\*.*?\*/", "", html, flags=re.S)
+    lines = []
+    for line in html.splitlines():
+        line = line.strip()
+        # Newlines are kept so JavaScript semicolon insertion still works
+        if line and not line.startswith("//"):
+            lines.append(line)
+    return "\n".join(lines)
+
+
+def c_array(data):
+    rows = []
+    for i in range(0, len(data), 16):
+        rows.append("    " + ", ".join("0x%02x" % b for b in data[i:i + 16]) + ",")
+    return "\n".join(rows)
+
+
+def c_string(text):
+    text = text.replace("\\", "\\\\").replace('"', '\\"').replace("\n", "\\n")
+    return '"' + text + '"'
+
+
+def render_template(name, html, slots):
+    parts = PLACEHOLDER.split(html)
+    names = [m[1:-1] for m in PLACEHOLDER.findall(html)]
+    out = ["// %s.html template: %d segments\n" % (name, len(parts))]
+    for i, part in enumerate(parts):
+        out.append("static const char %s_tpl_%d[] PROGMEM = %s;\n" % (name, i, c_string(part)))
+    out.append("static const char *const %s_tpl_segments[] = {\n" % name)
+    out.append("".join("    %s_tpl_%d,\n" % (name, i) for i in range(len(parts))))
+    out.append("};\n")
+    out.append("static const uint8_t %s_tpl_slots[] = {\n" % name)
+    out.append("".join("    TPL_%s,\n" % n for n in names))
+    out.append("    TPL_NONE,\n};\n")
+    out.append(
+        "static const PageTemplate %s_tpl = {%s_tpl_segments, %s_tpl_slots, %d};\n"
+        % (name, name, name, len(parts))
+    )
+    slots.update(names)
+    return "".join(out)
+
+
+def render_page(name, slots):
+    with open(os.path.join(PROJECT_DIR, "web", name + ".html"), encoding="utf-8") as f:
+        html = minify(f.read())
+    template = render_template(name, html, slots) if PLACEHOLDER.search(html) else ""
+    html = PLACEHOLDER.sub("--", html)
+    data = gzip.compress(html.encode("utf-8"), compresslevel=9, mtime=0)
+    etag = hashlib.sha1(data).hexdigest()[:16]
+    return (
+        "// %s.html: %d bytes minified, %d bytes gzipped\n"
+        "const uint8_t %s_html_gz[] PROGMEM = {\n%s\n};\n"
+        "const size_t %s_html_gz_len = %d;\n"
+        "const char %s_html_etag[] = \"\\\"%s\\\"\";\n"
+        % (name, len(html), len(data), name, c_array(data), name, len(data), name, etag)
+        + template
+    )
+
+
+def main():
+    slots = set()
+    body = "\n".join(render_page(name, slots) for name in PAGES)
+    slot_enum = "".join("  TPL_%s,\n" % n for n in sorted(slots))
+    header = (
+        "// Generated by tools/build_web_assets.py from web/*.html - do not edit.\n"
+        "#ifndef WEB_ASSETS_H\n"
+        "#define WEB_ASSETS_H\n\n"
+        "#include <Arduino.h>\n\n"
+        "#include \"template_renderer.h\"\n\n"
+        "enum TemplateSlot {\n" + slot_enum + "  TPL_NONE = 0xFF\n};\n\n"
+        + body
+        + "\n#endif\n"
+    )
+
+    # Only touch the header when it changes, to avoid needless rebuilds
+    if os.path.exists(OUTPUT):
+        with open(OUTPUT, encoding="utf-8") as f:
+            if f.read() == header:
+                return
+    with open(OUTPUT, "w", encoding="utf-8") as f:
+        f.write(header)
+    print("Generated " + os.path.relpath(OUTPUT, PROJECT_DIR))
+
+
+main()